@@ -4,10 +4,12 @@
 #include "graphics.h"
 #include "keyboard.h"
 #include "mouse.h"
+#include "frametimestats.h"
 #include <string>
 #include <cstdint>
 #include <functional>
 #include <chrono>
+#include <atomic>
 
 struct GLFWwindow;
 struct GLFWmonitor;
@@ -18,8 +20,10 @@ namespace vexed {
     using UpdateCallback = std::function<void(Application *application)>;
     using LoadCallback = std::function<void(Application *application)>;
     using CloseCallback = std::function<void(Application *application)>;
+    using FixedUpdateCallback = std::function<void(Application *application)>;
 
-    typedef std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> TimerInstance;
+    // Monotonic, so adjusting the system clock does not show up as a long or negative frame
+    typedef std::chrono::steady_clock::time_point TimerInstance;
 
     struct Timer {
         TimerInstance tp1;
@@ -28,13 +32,14 @@ namespace vexed {
         float elapsedTime;
         
         Timer() {
-            tp1 = std::chrono::system_clock::now();
-            tp1 = std::chrono::system_clock::now();
+            tp1 = std::chrono::steady_clock::now();
+            tp2 = tp1;
             deltaTime = 0;
+            elapsedTime = 0;
         }
         
         void update() {
-            tp2 = std::chrono::system_clock::now();
+            tp2 = std::chrono::steady_clock::now();
             std::chrono::duration<float> elapsed = tp2 - tp1;
             tp1 = tp2;
             deltaTime = elapsed.count();
@@ -46,7 +51,9 @@ namespace vexed {
         WindowFlags_None = 0,
         WindowFlags_VSync = 1 << 0,
         WindowFlags_Maximize = 1 << 1,
-        WindowFlags_Fullscreen = 1 << 2
+        WindowFlags_Fullscreen = 1 << 2,
+        WindowFlags_OnDemand = 1 << 3, //Sleeps until there is input, a redraw is requested or a requested animation frame is due
+        WindowFlags_AdaptiveVSync = 1 << 4 //Late frames are shown right away instead of waiting for the next vertical blank, regular vsync where that is not supported
     };
 
     typedef int WindowFlags;
@@ -63,6 +70,7 @@ namespace vexed {
     class Application {
     public:
         UpdateCallback update;
+        FixedUpdateCallback fixedUpdate; //Runs before update, once for every fixed time step that passed
         LoadCallback load;
         CloseCallback close;
         Application();
@@ -71,9 +79,17 @@ namespace vexed {
         inline Graphics *getGraphics() { return &graphics; }
         inline Keyboard *getKeyboard() { return &keyboard; }
         inline Mouse *getMouse() { return &mouse; }
+        inline FrameTimeStats *getFrameTimeStats() { return &frameTimeStats; }
         inline float getTime() const { return timer.elapsedTime; }
         inline float getDeltaTime() const { return timer.deltaTime; }
         inline float getFPS() const { return averageFPS; }
+        inline float getFixedTimeStep() const { return fixedTimeStep; }
+        void setFixedTimeStep(float seconds, uint32_t maxStepsPerFrame = 8); //0 disables fixedUpdate, time beyond the maximum number of steps is dropped
+        inline float getInterpolationAlpha() const { return interpolationAlpha; } //How far the frame is between the last fixed update and the next, from 0 to 1
+        inline float getFrameRateLimit() const { return frameRateLimit; }
+        void setFrameRateLimit(float framesPerSecond); //0 removes the limit
+        void requestRedraw(); //Runs another frame right away, may be called from any thread
+        void requestAnimationFrame(float time); //Runs a frame once getTime() reaches the time, every frame forgets the requests so they are repeated while needed
         inline static Application *getInstance() { return instance; }
     private:
         Configuration config;
@@ -83,10 +99,24 @@ namespace vexed {
         Keyboard keyboard;
         Mouse mouse;
         Timer timer;
+        FrameTimeStats frameTimeStats;
         float averageFPS;
+        std::atomic<bool> redrawRequested;
+        float nextAnimationFrame; //Earliest requested time, infinity when nothing is scheduled
+        float fixedTimeStep;
+        uint32_t maxFixedSteps;
+        float fixedTimeAccumulator;
+        float interpolationAlpha;
+        float frameRateLimit;
+        std::chrono::steady_clock::time_point nextFrameTime; //When the frame limiter lets the current frame end
+        std::chrono::steady_clock::duration sleepOvershoot; //How much later than asked the thread tends to wake up
         static Application *instance;
+        void waitEvents();
+        void runFixedUpdates();
+        void limitFrameRate();
         static void onFramebufferResize(GLFWwindow* window, int width, int height);
         static void onWindowPos(GLFWwindow *window, int xpos, int ypos);
+        static void onWindowRefresh(GLFWwindow *window);
         static void onKeyPress(GLFWwindow *window, int32_t key, int32_t scancode, int32_t action, int32_t mods);
         static void onCharPress(GLFWwindow* window, uint32_t codepoint);
         static void onMouseButtonPress(GLFWwindow *window, int32_t button, int32_t action, int32_t mods);
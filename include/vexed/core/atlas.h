@@ -0,0 +1,76 @@
+#ifndef VEXED_ATLAS_H
+#define VEXED_ATLAS_H
+
+#include "graphics.h"
+#include "image.h"
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+namespace vexed {
+    // Location of an image inside an atlas, only valid until the atlas is modified
+    struct AtlasRegion {
+        uint32_t textureId;
+        Vector2 uv0; //Top left
+        Vector2 uv1; //Bottom right
+        uint32_t width;
+        uint32_t height;
+    };
+
+    // Packs many small images into a few shared textures (pages), so drawing them does not require a texture switch per image
+    // Images are identified by the handle returned from 'add', which stays valid when pages grow or get repacked
+    class Atlas {
+    public:
+        static constexpr uint32_t INVALID_HANDLE = 0;
+        Atlas(uint32_t pageSize = 1024, uint32_t maxPageSize = 4096, uint32_t padding = 1);
+        uint32_t add(const Image *image);
+        uint32_t add(const uint8_t *data, uint32_t width, uint32_t height, uint32_t channels);
+        bool remove(uint32_t handle);
+        bool getRegion(uint32_t handle, AtlasRegion &region) const;
+        void defragment();
+        void destroy();
+        inline size_t getNumberOfPages() const { return pages.size(); }
+        inline size_t getNumberOfRegions() const { return numRegions; }
+    private:
+        struct SkylineNode {
+            uint32_t x;
+            uint32_t y;
+            uint32_t width;
+        };
+
+        struct Page {
+            uint32_t textureId;
+            uint32_t size;
+            std::vector<SkylineNode> skyline;
+            size_t usedArea;
+            size_t freedArea; //Area of removed regions, only given back when the page is repacked
+        };
+
+        struct Entry {
+            size_t page;
+            uint32_t x; //Position of the padded rectangle within the page
+            uint32_t y;
+            uint32_t width; //Size without padding
+            uint32_t height;
+            std::vector<uint8_t> pixels; //RGBA copy that is needed to repack the page
+            bool used;
+        };
+
+        uint32_t pageSize;
+        uint32_t maxPageSize;
+        uint32_t padding;
+        std::vector<Page> pages;
+        std::vector<Entry> entries; //Indexed by handle - 1
+        std::vector<uint32_t> freeHandles;
+        size_t numRegions;
+        bool insert(Page &page, uint32_t width, uint32_t height, uint32_t &x, uint32_t &y);
+        bool fit(const Page &page, size_t index, uint32_t width, uint32_t height, uint32_t &y) const;
+        bool place(Entry &entry, size_t pageIndex);
+        bool repack(size_t pageIndex, uint32_t newSize);
+        size_t createPage(uint32_t size);
+        void allocatePageTexture(Page &page);
+        void upload(const Entry &entry);
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,98 @@
+#ifndef VEXED_BACKEND_H
+#define VEXED_BACKEND_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+namespace vexed {
+    enum BackendType {
+        BackendType_OpenGL,
+        BackendType_Null
+    };
+
+    enum BufferUsage {
+        BufferUsage_Static,
+        BufferUsage_Dynamic,
+        BufferUsage_Stream
+    };
+
+    enum MapMode {
+        MapMode_Persistent, //Stays mapped while drawing, the buffer must have been allocated with allocatePersistentBuffer
+        MapMode_Unsynchronized //Invalidates the range, the caller is responsible for not overwriting data the GPU still reads
+    };
+
+    enum TextureFormat {
+        TextureFormat_R8,
+        TextureFormat_RGBA8
+    };
+
+    // Sampling uses the GL enum values, the same as TextureSettings
+    struct TextureDescription {
+        uint32_t width;
+        uint32_t height;
+        uint32_t channels; //Bytes per pixel of the data, from 1 to 4
+        TextureFormat format;
+        int32_t wrapS;
+        int32_t wrapT;
+        int32_t minFilter;
+        int32_t magFilter;
+        bool mipmaps;
+        const void *data; //May be nullptr to only allocate the storage
+    };
+
+    enum SubmissionKind {
+        SubmissionKind_Elements, //Every range of indices is drawn from its own base vertex, in a single call
+        SubmissionKind_ElementsInstanced, //The first count is the number of indices per instance
+        SubmissionKind_Arrays //The first count is the number of vertices, starting at vertex 0
+    };
+
+    struct DrawSubmission {
+        SubmissionKind kind;
+        uint8_t indexSize; //Either 2 or 4 bytes
+        const int32_t *counts;
+        const void *const *offsets; //Byte offsets into the bound element buffer
+        const int32_t *baseVertices;
+        size_t drawCount;
+        size_t instanceCount;
+    };
+
+    // Everything that creates, fills or draws GPU resources goes through the backend, so the CPU side of the library can run
+    // without a context. Pure state (bindings, vertex layouts, uniforms, queries) is still set with GL calls, a backend without
+    // a context has to make those harmless when it is activated
+    // Buffer functions take the buffer by name and bind it themselves where the API needs that, without disturbing other bindings
+    class Backend {
+    public:
+        Backend() : destroyedPrograms(0) {}
+        virtual ~Backend() {}
+        virtual BackendType getType() const = 0;
+        virtual void activate() {}
+        virtual void deactivate() {}
+        virtual uint32_t createBuffer() = 0;
+        virtual void destroyBuffer(uint32_t buffer) = 0;
+        virtual void allocateBuffer(uint32_t buffer, size_t size, const void *data, BufferUsage usage) = 0;
+        virtual bool supportsPersistentMapping() const = 0;
+        virtual void allocatePersistentBuffer(uint32_t buffer, size_t size) = 0;
+        virtual void updateBuffer(uint32_t buffer, size_t offset, size_t size, const void *data) = 0;
+        virtual void *mapBuffer(uint32_t buffer, size_t offset, size_t size, MapMode mode) = 0;
+        virtual void unmapBuffer(uint32_t buffer) = 0;
+        virtual void copyBuffer(uint32_t source, uint32_t destination, size_t sourceOffset, size_t destinationOffset, size_t size) = 0; //Stays on the GPU, neither buffer may be mapped unless it is persistent
+        virtual uint32_t createTexture(const TextureDescription &description) = 0;
+        virtual void updateTexture(uint32_t texture, uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint32_t channels, const void *data) = 0;
+        virtual void destroyTexture(uint32_t texture) = 0;
+        virtual uint32_t createFramebuffer(uint32_t texture) = 0; //Renders into the texture, 0 when the framebuffer is incomplete
+        virtual void destroyFramebuffer(uint32_t framebuffer) = 0;
+        virtual uint32_t createProgram(const std::string &vertexSource, const std::string &fragmentSource) = 0; //0 when compiling or linking fails
+        virtual void destroyProgram(uint32_t program) = 0;
+        virtual void submit(const DrawSubmission &submission) = 0; //Draws with the currently bound program and vertex array
+        inline uint64_t getDestroyedPrograms() const { return destroyedPrograms; } //Changes whenever a program name may be reused
+        static Backend *getInstance();
+        static void setInstance(Backend *backend); //nullptr selects the OpenGL backend, has to happen before any resource is created
+    protected:
+        uint64_t destroyedPrograms;
+    private:
+        static Backend *instance;
+    };
+}
+
+#endif
\ No newline at end of file
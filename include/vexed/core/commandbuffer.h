@@ -0,0 +1,55 @@
+#ifndef VEXED_COMMANDBUFFER_H
+#define VEXED_COMMANDBUFFER_H
+
+#include "graphics.h"
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+namespace vexed {
+    struct RecordedCommand {
+        size_t vertexOffset;
+        size_t numVertices;
+        size_t indexOffset;
+        size_t numIndices; //Zero means the vertices are a list of quads
+        size_t instanceOffset;
+        size_t numInstances; //Non zero means the command is a run of SDF shapes for the instanced pipeline, it has no vertices
+        uint32_t textureId; //Zero means the default white texture of Graphics
+        uint32_t shaderId;
+        bool textureIsFont;
+        Rectangle clippingRect;
+        void *userData;
+        int32_t layer;
+    };
+
+    // Records geometry on the CPU only, so it can be filled on any thread without a GL context
+    // A buffer must only be used by one thread at a time, Graphics::addCommandBuffers merges buffers on the render thread
+    class CommandBuffer {
+    friend class Graphics;
+    public:
+        CommandBuffer();
+        void clear(); //Keeps the allocated memory, so a buffer can be refilled every frame
+        void addVertices(const Vertex *vertices, size_t numVertices, const uint32_t *indices, size_t numIndices, uint32_t textureId = 0, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0), uint32_t shaderId = 0, void *userData = nullptr);
+        void addRectangle(const Vector2 &position, const Vector2 &size, float rotationDegrees, const Color &color, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0), uint32_t shaderId = 0, void *userData = nullptr);
+        void addRectangles(const Rectangle *rectangles, size_t count, const Color &color, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0), uint32_t shaderId = 0, void *userData = nullptr);
+        void addCircle(const Vector2 &position, float radius, int segments, float rotationDegrees, const Color &color, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0), uint32_t shaderId = 0, void *userData = nullptr);
+        void addLine(const Vector2 &p1, const Vector2 &p2, float thickness, const Color &color, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0), uint32_t shaderId = 0, void *userData = nullptr);
+        void addLines(const Vector2 *segments, size_t count, float thickness, const Color &color, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0), uint32_t shaderId = 0, void *userData = nullptr);
+        void addTriangle(const Vector2 &position, const Vector2 &size, float rotationDegrees, const Color &color, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0), uint32_t shaderId = 0, void *userData = nullptr);
+        void addImage(const Vector2 &position, const Vector2 &size, float rotationDegrees, uint32_t textureId, const Color &color = Color(1, 1, 1, 1), const Vector2 &uv0 = Vector2(0, 0), const Vector2 &uv1 = Vector2(1, 1), const Rectangle &clippingRect = Rectangle(0, 0, 0, 0), uint32_t shaderId = 0, void *userData = nullptr);
+        inline int32_t getLayer() const { return layer; }
+        inline void setLayer(int32_t layer) { this->layer = layer; }
+        inline size_t getNumberOfCommands() const { return commands.size(); }
+        inline size_t getNumberOfVertices() const { return vertices.size(); }
+    private:
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        std::vector<InstanceData> instances;
+        std::vector<RecordedCommand> commands;
+        int32_t layer;
+        Vertex *addQuads(size_t numQuads, uint32_t textureId, const Rectangle &clippingRect, uint32_t shaderId, void *userData);
+        void addShape(const InstanceData &instance, const Rectangle &clippingRect, void *userData);
+    };
+}
+
+#endif
\ No newline at end of file
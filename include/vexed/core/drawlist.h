@@ -0,0 +1,34 @@
+#ifndef VEXED_DRAWLIST_H
+#define VEXED_DRAWLIST_H
+
+#include "graphics.h"
+#include <cstdint>
+#include <vector>
+
+namespace vexed {
+    // Geometry that is recorded once between Graphics::beginDrawList and Graphics::endDrawList and kept in its own GPU buffers
+    // Replaying it with Graphics::addDrawList only costs the draw calls, the list is never rebuilt until it is invalidated
+    class DrawList {
+    friend class Graphics;
+    public:
+        DrawList();
+        inline bool isValid() const { return valid; }
+        inline Rectangle getBounds() const { return bounds; }
+        void invalidate();
+        void destroy();
+    private:
+        uint32_t VAO;
+        uint32_t VBO;
+        uint32_t EBO;
+        uint32_t instanceVAO;
+        uint32_t instanceVBO;
+        VertexFormat vertexFormat;
+        std::vector<DrawListItem> items;
+        std::vector<DrawBatch> batches;
+        Rectangle bounds;
+        uint64_t revision; //Changes whenever the list is invalidated, so replays can tell a new recording apart
+        bool valid;
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,65 @@
+#ifndef VEXED_FRAMETIMESTATS_H
+#define VEXED_FRAMETIMESTATS_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace vexed {
+    enum FrameTimeKind {
+        FrameTimeKind_Frame, //From the start of a frame to the start of the next, without the time slept in on-demand mode
+        FrameTimeKind_Update, //Input, fixed updates and the update callback
+        FrameTimeKind_Render, //Graphics::newFrame
+        FrameTimeKind_Swap, //Presenting, zero for frames that were skipped
+        FrameTimeKind_COUNT
+    };
+
+    // Milliseconds over the frames in the window
+    struct FrameTimeSummary {
+        double p50;
+        double p95;
+        double p99;
+        double max;
+        double mean;
+        size_t samples;
+        FrameTimeSummary() : p50(0.0), p95(0.0), p99(0.0), max(0.0), mean(0.0), samples(0) {}
+    };
+
+    // Durations of the most recent frames, kept both as samples and as a histogram per kind
+    // Percentiles come from the histogram and are interpolated within a bucket, the maximum and mean are exact
+    class FrameTimeStats {
+    public:
+        static constexpr size_t HISTOGRAM_BUCKETS = 1000;
+        static constexpr double BUCKET_WIDTH = 0.1; //Milliseconds, the last bucket also holds everything slower
+        FrameTimeStats();
+        void addFrame(double frame, double update, double render, double swap); //Milliseconds
+        void reset();
+        inline size_t getWindowSize() const { return windowSize; }
+        void setWindowSize(size_t frames); //Clears the collected frames
+        inline double getBudget() const { return budget; }
+        void setBudget(double milliseconds); //Frames that take longer are counted as over budget, 0 counts none
+        inline size_t getFrameCount() const { return count; } //In the window
+        inline uint64_t getTotalFrames() const { return totalFrames; }
+        inline size_t getFramesOverBudget() const { return framesOverBudget; } //In the window
+        inline uint64_t getTotalFramesOverBudget() const { return totalFramesOverBudget; }
+        FrameTimeSummary getSummary(FrameTimeKind kind) const;
+        double getPercentile(FrameTimeKind kind, double percentile) const; //Percentile from 0 to 100
+        size_t getSamples(FrameTimeKind kind, float *samples, size_t maxCount) const; //Copies up to maxCount of the latest frames, oldest first, returns the number copied
+        size_t getHistogram(FrameTimeKind kind, uint32_t *counts, size_t maxCount) const; //Bucket i counts durations from i to i + 1 times BUCKET_WIDTH
+        bool exportCSV(const std::string &filePath) const; //One row per frame in the window, oldest first
+    private:
+        std::vector<float> samples[FrameTimeKind_COUNT]; //Ring of windowSize frames
+        std::vector<uint32_t> histograms[FrameTimeKind_COUNT];
+        size_t windowSize;
+        size_t head; //Ring index the next frame is written to
+        size_t count;
+        uint64_t totalFrames;
+        double budget;
+        size_t framesOverBudget;
+        uint64_t totalFramesOverBudget;
+        static size_t getBucket(float duration);
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,34 @@
+#ifndef VEXED_GLBACKEND_H
+#define VEXED_GLBACKEND_H
+
+#include "backend.h"
+
+namespace vexed {
+    // Needs a current OpenGL 3.3 context, persistent mapping is used when the context is 4.4 or newer
+    class GLBackend : public Backend {
+    public:
+        BackendType getType() const override { return BackendType_OpenGL; }
+        uint32_t createBuffer() override;
+        void destroyBuffer(uint32_t buffer) override;
+        void allocateBuffer(uint32_t buffer, size_t size, const void *data, BufferUsage usage) override;
+        bool supportsPersistentMapping() const override;
+        void allocatePersistentBuffer(uint32_t buffer, size_t size) override;
+        void updateBuffer(uint32_t buffer, size_t offset, size_t size, const void *data) override;
+        void *mapBuffer(uint32_t buffer, size_t offset, size_t size, MapMode mode) override;
+        void unmapBuffer(uint32_t buffer) override;
+        void copyBuffer(uint32_t source, uint32_t destination, size_t sourceOffset, size_t destinationOffset, size_t size) override;
+        uint32_t createTexture(const TextureDescription &description) override;
+        void updateTexture(uint32_t texture, uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint32_t channels, const void *data) override;
+        void destroyTexture(uint32_t texture) override;
+        uint32_t createFramebuffer(uint32_t texture) override;
+        void destroyFramebuffer(uint32_t framebuffer) override;
+        uint32_t createProgram(const std::string &vertexSource, const std::string &fragmentSource) override;
+        void destroyProgram(uint32_t program) override;
+        void submit(const DrawSubmission &submission) override;
+    private:
+        static bool checkShader(uint32_t handle, const char *description);
+        static bool checkProgram(uint32_t handle, const char *description);
+    };
+}
+
+#endif
\ No newline at end of file
@@ -2,13 +2,24 @@
 #define VEXED_GRAPHICS_H
 
 #include "font.h"
+#include "statecache.h"
 #include <cstdint>
 #include <cstdlib>
 #include <string>
 #include <vector>
 #include <functional>
+#include <unordered_map>
+#include <chrono>
 
 namespace vexed {
+    class Atlas;
+    class DrawList;
+    class CommandBuffer;
+    class SpriteBatch;
+    class PlotBuffer;
+    class Backend;
+    class RenderTarget;
+
     struct Vector2 {
         float x;
         float y;
@@ -30,6 +41,14 @@ namespace vexed {
         bool isZero() const {
             return x == 0.0f && y == 0.0f && width == 0.0f && height == 0.0f;
         }
+        // The size is not clamped, so rectangles that do not overlap result in a negative width or height
+        Rectangle intersect(const Rectangle &other) const {
+            float left = x > other.x ? x : other.x;
+            float top = y > other.y ? y : other.y;
+            float right = x + width < other.x + other.width ? x + width : other.x + other.width;
+            float bottom = y + height < other.y + other.height ? y + height : other.y + other.height;
+            return Rectangle(left, top, right - left, bottom - top);
+        }
         static Rectangle getRectAtRowAndColumn(float leftIndent, float topIndent, float width, float height, int row, int column, int offsetX = 0, int offsetY = 0) {
             float x = leftIndent + (column * (width + offsetX));
             float y = topIndent + (row * (height + offsetY));
@@ -189,26 +208,139 @@ namespace vexed {
             color(color) {}
     };
 
+    // Packed layout used by VertexFormat_Compact, the uv is stored as normalized 16 bit integers and the color as RGBA8
+    // UVs are clamped to [0, 1], geometry that repeats a texture needs VertexFormat_Default
+    struct CompactVertex {
+        Vector2 position;
+        uint16_t uv[2];
+        uint8_t color[4];
+    };
+
+    enum VertexFormat {
+        VertexFormat_Default,
+        VertexFormat_Compact
+    };
+
+    enum LineJoin {
+        LineJoin_Miter, //Falls back to a bevel when the miter gets longer than 4 times the half thickness
+        LineJoin_Bevel,
+        LineJoin_Round
+    };
+
+    enum LineCap {
+        LineCap_Butt,
+        LineCap_Square, //Extends the ends by half the thickness
+        LineCap_Round
+    };
+
+    enum PlotLinesMode {
+        PlotLinesMode_Segments, //An independent quad per pair of values
+        PlotLinesMode_Polyline //A single polyline with mitered joins, about half the vertices of the segments
+    };
+
+    enum InstanceKind {
+        InstanceKind_Rectangle,
+        InstanceKind_Ellipse,
+        InstanceKind_Shape //SDF shape described by InstanceData::shape, the uvs hold local coordinates instead of texture coordinates
+    };
+
+    // Per-instance attributes of the instanced primitive path, the vertex shader expands these onto a unit quad
+    struct InstanceData {
+        Vector2 position; //Top left corner before rotation
+        Vector2 size;
+        Vector2 uv0;
+        Vector2 uv1;
+        uint8_t color[4];
+        float rotation; //Radians, rotates around the center
+        uint32_t kind;
+        // Only read for InstanceKind_Shape, the local coordinates span [-1, 1] over the shape
+        // x is the corner radius in pixels, a negative radius makes an ellipse
+        // y is the outline thickness in pixels, zero fills the shape
+        Vector2 shape;
+
+        // The quad is padded by a pixel on each side so the anti-aliased edge is not cut off
+        static InstanceData createShape(const Vector2 &position, const Vector2 &size, float rotationDegrees, const Color &color, const Vector2 &shape);
+    };
+
     struct DrawListItem {
         uint32_t shaderId;
         uint32_t textureId;
         size_t vertexOffset;
         size_t vertexCount;
         size_t indiceCount;
-        size_t indiceOffset;
+        size_t indiceOffset; //Byte offset into the index stream of the frame
+        size_t instanceOffset;
+        size_t instanceCount; //Items with a non zero instance count are drawn with the instanced pipeline
+        uint8_t indexSize; //Either 2 or 4 bytes
+        bool quads; //Vertices are consecutive quads and use the static quad index pattern, no indices are stored
         bool textureIsFont;
+        bool premultiplied; //Colors are already multiplied by their alpha, like the texture of a render target
         Rectangle clippingRect;
         void *userData;
+        Rectangle bounds; //Screen space area the item can touch, used to decide whether items may be reordered
+        int32_t layer;
+        uint64_t sortKey;
+        uint64_t geometryHash; //Of the vertices and indices as they were passed in, only set while damage tracking is enabled
+        size_t replay; //Index of the replayed draw list in Graphics::replays, NO_REPLAY for regular geometry
+        size_t plot; //Index of the plot buffer in Graphics::plots, NO_PLOT for regular geometry
+        static constexpr size_t NO_REPLAY = SIZE_MAX;
+        static constexpr size_t NO_PLOT = SIZE_MAX;
+    };
+
+    struct DrawListReplay {
+        const DrawList *drawList;
+        float model[16];
+        Rectangle clippingRect; //Screen space, not flipped
+    };
+
+    struct PlotBufferDraw {
+        const PlotBuffer *plotBuffer;
+        Rectangle rectangle;
+        float scale; //Maps a sample to [0, 1] as sample * scale + offset
+        float offset;
+        float thickness;
+        Color color;
+    };
+
+    // Location of the optional uModel uniform of a program and the replay whose transform it currently holds
+    struct ModelUniform {
+        int32_t location;
+        size_t replay;
+    };
+
+    // Locations of the uProjection and uTime uniforms that a program declares outside of the frame uniform block, and the
+    // values they currently hold
+    struct LegacyFrameUniforms {
+        int32_t projectionLocation;
+        int32_t timeLocation;
+        uint64_t projectionRevision;
+        float time;
+    };
+
+    // Items of the same layer and state that are drawn together after sorting, linked through Graphics::sortNext
+    struct SortGroup {
+        uint64_t key;
+        int32_t layer;
+        size_t firstItem;
+        size_t lastItem;
+        Rectangle bounds;
+    };
+
+    // A range of consecutive draw list items that share the same state and are submitted with a single draw call
+    struct DrawBatch {
+        size_t itemOffset;
+        size_t itemCount;
     };
 
     struct DrawCommand {
         Vertex *vertices;
         size_t numVertices;
-        uint32_t *indices;
+        uint32_t *indices; //Indices are relative to the first vertex of the command, nullptr means the vertices are a list of quads
         size_t numIndices;
         uint32_t textureId;
         uint32_t shaderId;
         bool textureIsFont;
+        bool premultiplied;
         Rectangle clippingRect;
         void *userData;
         DrawCommand() : vertices(nullptr), 
@@ -217,6 +349,7 @@ namespace vexed {
             numIndices(0), 
             textureId(0), 
             textureIsFont(false),
+            premultiplied(false),
             clippingRect(Rectangle(0, 0, 0, 0)),
             userData(nullptr) {}
     };
@@ -233,71 +366,314 @@ namespace vexed {
         unsigned char blendEnabled;
         int blendSrcFactor;
         int blendDstFactor;
+        int blendSrcAlphaFactor;
+        int blendDstAlphaFactor;
         int blendEquation;
         int depthFunc;
     };
 
+    // Mirrors the std140 layout of the VexedFrame uniform block (see shader.h)
+    struct FrameUniforms {
+        float projection[16];
+        float viewport[4];
+        float time;
+        float padding[3];
+    };
+
     enum Uniform {
-        Uniform_Projection,
         Uniform_Texture,
-        Uniform_Time,
         Uniform_IsFont,
         Uniform_COUNT
     };
 
+    enum PlotUniform {
+        PlotUniform_Samples,
+        PlotUniform_Start,
+        PlotUniform_Capacity,
+        PlotUniform_Rectangle,
+        PlotUniform_Scale,
+        PlotUniform_Thickness,
+        PlotUniform_Color,
+        PlotUniform_COUNT
+    };
+
+    enum BufferUploadMode {
+        BufferUploadMode_SubData,
+        BufferUploadMode_RingBuffer
+    };
+
+    // Changes are found by hashing the items of a frame, which covers geometry, state, draw list recordings and plot samples
+    // Texture contents and custom uniforms are not part of it, use Graphics::addDamage or Graphics::invalidate for those
+    enum DamageTracking {
+        DamageTracking_None, //Every frame is drawn
+        DamageTracking_SkipFrames, //A frame that is identical to the previous one is not drawn at all
+        DamageTracking_Partial //Only the changed area is redrawn into a persistent frame target, which is then copied to the screen
+    };
+
+    // Counters of a single frame, the vertex, index and item counts cover everything that was added for the frame
+    struct FrameStats {
+        uint64_t frame;
+        size_t items;
+        size_t instances;
+        size_t vertices;
+        size_t indices;
+        size_t drawCalls;
+        size_t mergedItems;
+        size_t uploadedBytes; //Geometry, instances, uniforms, plot samples and recorded draw lists
+        size_t shaderSwitches;
+        size_t textureSwitches;
+        size_t scissorChanges;
+        size_t bufferReallocations;
+        double recordTime; //Milliseconds between the end of the previous newFrame and the start of this one
+        double submitTime; //Milliseconds spent in newFrame
+        double gpuTime; //Milliseconds, negative until the timer query of the frame has a result, which takes a few frames
+        bool skipped; //Damage tracking found nothing that changed, so nothing was drawn
+        Rectangle damage; //Screen space area that was redrawn
+        FrameStats() : frame(0), items(0), instances(0), vertices(0), indices(0), drawCalls(0), mergedItems(0), uploadedBytes(0),
+            shaderSwitches(0), textureSwitches(0), scissorChanges(0), bufferReallocations(0), recordTime(0.0), submitTime(0.0), gpuTime(-1.0),
+            skipped(false) {}
+    };
+
     using UniformUpdateCallback = std::function<void(uint32_t shaderId, void *userData)>;
 
     class Graphics {
+    friend class SpriteBatch;
     public:
         UniformUpdateCallback uniformUpdate;
         Graphics();
         void initialize();
         void deinitialize();
-        void newFrame(float deltaTime);
+        bool newFrame(float deltaTime); //False when damage tracking skipped the frame, the previous frame is then still the one to show
         void addRectangle(const Vector2 &position, const Vector2 &size, float rotationDegrees, const Color &color, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0), uint32_t shaderId = 0, void *userData = nullptr);
+        void addRectangles(const Rectangle *rectangles, size_t count, const Color &color, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0), uint32_t shaderId = 0, void *userData = nullptr);
         void addCircle(const Vector2 &position, float radius, int segments, float rotationDegrees, const Color &color, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0), uint32_t shaderId = 0, void *userData = nullptr);
         void addLine(const Vector2 &p1, const Vector2 &p2, float thickness, const Color &color, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0), uint32_t shaderId = 0, void *userData = nullptr);
         void addLines(const Vector2 *segments, size_t count, float thickness, const Color &color, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0), uint32_t shaderId = 0, void *userData = nullptr);
-        void addPlotLines(const Vector2 &position, const Vector2 &size, const float *data, int valuesCount, float thickness, const Color &color, float scaleMin = 3.402823466e+38F, float scaleMax = 3.402823466e+38F, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0), uint32_t shaderId = 0, void *userData = nullptr);
+        void addPolyline(const Vector2 *points, size_t count, float thickness, LineJoin join, LineCap cap, const Color &color, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0), uint32_t shaderId = 0, void *userData = nullptr); //Consecutive segments share their vertices
+        void addPlotLines(const Vector2 &position, const Vector2 &size, const float *data, int valuesCount, float thickness, const Color &color, float scaleMin = 3.402823466e+38F, float scaleMax = 3.402823466e+38F, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0), uint32_t shaderId = 0, void *userData = nullptr, PlotLinesMode mode = PlotLinesMode_Segments);
         void addTriangle(const Vector2 &position, const Vector2 &size, float rotationDegrees, const Color &color, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0), uint32_t shaderId = 0, void *userData = nullptr);
         void addText(const Vector2 &position, Font *font, bool richText, const std::string &text, float fontSize, const Color &color, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0));
         void addImage(const Vector2 &position, const Vector2 &size, float rotationDegrees, uint32_t textureId, const Color &color = Color(1, 1, 1, 1), const Vector2 &uv0 = Vector2(0, 0), const Vector2 &uv1 = Vector2(1, 1), const Rectangle &clippingRect = Rectangle(0, 0, 0, 0), uint32_t shaderId = 0, void *userData = nullptr);
+        void addEllipse(const Vector2 &center, const Vector2 &radii, float rotationDegrees, const Color &color, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0), void *userData = nullptr);
+        void addRoundedRectangle(const Vector2 &position, const Vector2 &size, float cornerRadius, float rotationDegrees, const Color &color, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0), void *userData = nullptr);
+        void addRing(const Vector2 &center, float radius, float thickness, const Color &color, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0), void *userData = nullptr); //The ring lies inside the radius
+        void addBorder(const Vector2 &position, const Vector2 &size, float thickness, float cornerRadius, const Color &color, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0), void *userData = nullptr); //The border lies inside the rectangle
+        bool beginDrawList(DrawList *drawList);
+        void endDrawList();
+        void addDrawList(const DrawList *drawList, const Vector2 &translation = Vector2(0, 0), const Vector2 &scale = Vector2(1, 1), float rotationDegrees = 0.0f, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0));
+        bool beginRenderTarget(RenderTarget *target, const Vector2 &origin = Vector2(0, 0)); //The origin is the position that ends up in the top left corner of the target
+        void endRenderTarget();
+        void addRenderTarget(const RenderTarget *target, const Vector2 &position, const Vector2 &size, float opacity = 1.0f, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0));
+        inline bool isRecording() const { return recordingList != nullptr; } //Either a draw list or a render target
+        void addCommandBuffers(const CommandBuffer *commandBuffers, size_t count); //Must be called from the render thread once the buffers are no longer written to
+        void addPlotBuffer(PlotBuffer *plotBuffer, const Vector2 &position, const Vector2 &size, float thickness, const Color &color, float scaleMin, float scaleMax, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0)); //Uploads the new samples and draws the line in a single draw call
+        void addImage(const Vector2 &position, const Vector2 &size, float rotationDegrees, const Atlas *atlas, uint32_t regionHandle, const Color &color = Color(1, 1, 1, 1), const Vector2 &uv0 = Vector2(0, 0), const Vector2 &uv1 = Vector2(1, 1), const Rectangle &clippingRect = Rectangle(0, 0, 0, 0), uint32_t shaderId = 0, void *userData = nullptr); //UVs are relative to the atlas region
         inline Viewport getViewport() const { return viewport; }
         void setViewport(uint32_t x, uint32_t y, uint32_t width, uint32_t height);
         inline Color getClearColor() const { return clearColor; }
         void setClearColor(const Color &color);
         inline size_t getDrawCalls() const { return numDrawCalls; }
+        inline size_t getMergedItems() const { return numMergedItems; }
+        inline BufferUploadMode getBufferUploadMode() const { return uploadMode; }
+        void setBufferUploadMode(BufferUploadMode mode); //Takes effect once the geometry added so far has been submitted
+        inline VertexFormat getVertexFormat() const { return vertexFormat; }
+        void setVertexFormat(VertexFormat format);
+        inline bool isInstancingEnabled() const { return instancingEnabled; }
+        void setInstancingEnabled(bool enabled);
+        inline bool isContextOwned() const { return contextOwned; }
+        inline void setContextOwned(bool owned) { contextOwned = owned; stateSaved = false; } //When set, GL state is neither saved nor restored around a frame
+        // Otherwise the blend and depth state of the application is saved with 8 glGet queries before the first frame, and restored after
+        // every frame. It is saved again after this call, which is needed whenever the application changed that state in between
+        inline void invalidateState() { stateSaved = false; }
+        inline size_t getIssuedStateChanges() const { return numIssuedStateChanges; }
+        inline size_t getSkippedStateChanges() const { return numSkippedStateChanges; }
+        inline int32_t getLayer() const { return layer; }
+        void setLayer(int32_t layer); //Items are drawn in order of their layer, this applies to everything added after the call
+        inline bool isSortingEnabled() const { return sortingEnabled; }
+        inline void setSortingEnabled(bool enabled) { sortingEnabled = enabled; }
+        const FrameStats &getFrameStats() const; //Of the most recent frame
+        size_t getFrameStatsHistory(FrameStats *stats, size_t maxCount) const; //Copies up to maxCount of the latest frames, oldest first, returns the number copied
+        inline size_t getFrameStatsHistorySize() const { return statsHistory.size(); }
+        void setFrameStatsHistorySize(size_t frames); //Clears the history
+        void pushClip(const Rectangle &rect); //Intersected with the current clip, applies to everything added until the matching popClip
+        void popClip();
+        Rectangle getClip() const; //Zero when nothing is pushed
+        inline DamageTracking getDamageTracking() const { return damageTracking; }
+        void setDamageTracking(DamageTracking mode); //The next frame is drawn completely
+        void addDamage(const Rectangle &rect); //Redraws the area with the next frame, even when its items did not change
+        void invalidate(); //Redraws the whole next frame
     private:
+        static constexpr size_t RING_BUFFER_REGIONS = 3;
+        static constexpr size_t SORT_LOOKBACK = 64; //Number of groups an item may move back past
+        static constexpr size_t MAX_QUADS_PER_DRAW = 65536 / 4;
+        static constexpr size_t QUAD_PATTERN_SIZE = MAX_QUADS_PER_DRAW * 6 * sizeof(uint16_t); //Stored at the start of the element buffer
+        static constexpr size_t MODEL_UNIFORM_UNKNOWN = SIZE_MAX - 1; //Forces the next model matrix to be uploaded
+        static constexpr size_t TIMER_QUERY_COUNT = 4; //Frames the GPU may lag behind before a frame goes without a timing
+        static constexpr float POLYLINE_MITER_LIMIT = 4.0f; //In multiples of the half thickness
+        static constexpr size_t POLYLINE_MAX_ROUND_STEPS = 16; //Triangles per round join or cap
         uint32_t VAO;
         uint32_t VBO;
         uint32_t EBO;
+        uint32_t quadPatternBuffer; //Holds only the quad pattern, element buffers get it by a copy on the GPU
         uint32_t shaderId;
         uint32_t textureId;
         int32_t uniforms[Uniform_COUNT];
+        uint32_t instanceVAO;
+        uint32_t instanceVBO;
+        uint32_t quadVBO;
+        uint32_t quadEBO;
+        uint32_t instanceShaderId;
+        int32_t instanceUniforms[Uniform_COUNT];
+        uint32_t plotShaderId;
+        int32_t plotUniforms[PlotUniform_COUNT];
+        std::vector<PlotBufferDraw> plots;
+        size_t plotCount;
+        uint32_t frameUBO;
+        FrameUniforms frameUniforms;
+        uint64_t projectionRevision; //Changes whenever the projection of the frame uniforms does
+        std::vector<InstanceData> instances;
+        size_t instanceCount;
+        bool instancingEnabled;
         std::vector<DrawListItem> items;
-        std::vector<Vertex> vertices;
-        std::vector<uint32_t> indices;
+        std::vector<uint8_t> vertices; //Geometry of the frame, in ring buffer mode only that of a draw list being recorded
+        std::vector<uint8_t> indices;
+        uint8_t *vertexData; //Points to either 'vertices' or the mapped region of the ring buffer
+        uint8_t *indexData; //Points to either 'indices' or the mapped region of the ring buffer
+        size_t mappedVertexStart; //First vertex of the frame that vertexData points to, geometry before it was copied on the GPU
+        size_t mappedIndexStart; //In bytes
+        size_t vertexCapacity;
+        size_t indexCapacity; //In bytes
+        BufferUploadMode uploadMode;
+        VertexFormat vertexFormat;
+        VertexFormat requestedVertexFormat;
+        BufferUploadMode requestedUploadMode;
+        size_t vertexStride;
+        bool persistentMapping;
+        size_t ringRegion;
+        void *ringFences[RING_BUFFER_REGIONS];
+        uint8_t *mappedVertices;
+        uint8_t *mappedIndices;
         size_t itemCount;
         size_t vertexCount;
-        size_t indiceCount;
+        size_t indexByteCount;
+        std::vector<DrawBatch> batches;
+        int32_t layer;
+        bool layersUsed;
+        bool sortingEnabled;
+        std::vector<size_t> sortOrder;
+        std::vector<size_t> sortNext;
+        std::vector<SortGroup> sortGroups;
+        std::vector<DrawListItem> sortedItems;
+        std::vector<InstanceData> sortedInstances;
+        DrawList *recordingList;
+        size_t recordItemOffset; //Items before this offset belong to the frame and must not be extended while recording
+        size_t recordVertexOffset;
+        size_t recordIndexOffset;
+        size_t recordInstanceOffset;
+        std::vector<DrawListReplay> replays;
+        size_t replayCount;
+        RenderTarget *recordingTarget;
+        std::vector<RenderTarget*> targets; //Recorded this frame, drawn before everything else
+        size_t targetCount;
+        bool renderingTarget;
+        DamageTracking damageTracking;
+        std::vector<uint64_t> itemHashes;
+        std::vector<uint64_t> previousHashes; //Of the items drawn by the previous frame, in drawing order
+        std::vector<Rectangle> previousBounds;
+        uint64_t previousFrameHash;
+        Rectangle pendingDamage;
+        bool fullDamage;
+        RenderTarget *frameTarget; //Holds the last frame for partial redraws
+        bool frameTargetStale; //The frame target does not hold the last frame, so it can not be partially redrawn
+        bool partialRedraw;
+        Rectangle damageScissor; //Flipped damaged area, everything is clipped to it during a partial redraw
+        std::unordered_map<uint32_t, ModelUniform> modelUniforms;
+        std::unordered_map<uint32_t, LegacyFrameUniforms> legacyFrameUniforms;
+        uint64_t destroyedPrograms; //Count of the backend when the uniform caches were last known to be valid
+        std::vector<int32_t> drawCounts;
+        std::vector<const void*> drawOffsets;
+        std::vector<int32_t> drawBaseVertices;
         std::vector<Vertex> vertexBufferTemp; //Temporary buffer used by some 'add' functions with dynamic size requirements
+        std::vector<Vector2> segmentBufferTemp; //Line segments of 'addPlotLines', as pairs of points
+        std::vector<Vector2> pointBufferTemp; //Points of 'addPolyline' without repeats
         std::vector<uint32_t> indexBufferTemp; //Temporary buffer used by some 'add' functions with dynamic size requirements
+        std::vector<InstanceData> culledInstancesTemp; //Runs of 'addInstances' that are outside of their clipping rectangle
+        std::vector<Vertex> clipBufferTemp; //Quads of 'addVertices' after clipping them to their clipping rectangle
+        std::vector<Rectangle> clipStack;
         Viewport viewport;
         Color clearColor;
         GLState glState;
+        StateCache stateCache;
+        Backend *backend;
+        bool contextOwned;
+        bool stateSaved; //glState holds the state of the application, see invalidateState
         float elapsedTime;
         size_t numDrawCalls;
+        size_t numMergedItems;
+        size_t numIssuedStateChanges;
+        size_t numSkippedStateChanges;
+        size_t numUploadedBytes;
+        size_t numBufferReallocations;
+        FrameStats frameStats;
+        std::vector<FrameStats> statsHistory; //Ring indexed by frame number
+        uint64_t frameNumber;
+        uint64_t statsHistoryStart; //First frame that is in the history
+        std::chrono::steady_clock::time_point frameEndTime;
+        uint32_t timerQueries[TIMER_QUERY_COUNT];
+        uint64_t timerQueryFrames[TIMER_QUERY_COUNT];
+        bool timerQueryPending[TIMER_QUERY_COUNT];
+        size_t activeTimerQuery; //TIMER_QUERY_COUNT when no query was started for the current frame
+        void sortItems();
+        static size_t batchItems(const DrawListItem *items, size_t count, std::vector<DrawBatch> &batches);
+        void applyItemState(const DrawListItem &item, const Rectangle &clippingRect, size_t replay);
+        void setBlendFunc(bool premultiplied);
+        void setModelUniform(uint32_t programId, size_t replay);
+        void setLegacyFrameUniforms(uint32_t programId);
+        void drawBatch(const DrawListItem *items, const DrawBatch &batch, size_t baseVertex, size_t indexOffset, uint32_t instanceBuffer);
+        void replayDrawList(const DrawListItem &item);
+        void drawRenderTargets();
+        void drawPlotBuffer(const DrawListItem &item);
+        void setScissor(const Rectangle &clippingRect);
+        uint64_t hashItem(const DrawListItem &item) const;
+        bool findDamage(Rectangle &damage, bool partial);
+        bool prepareFrameTarget();
+        void cullItems(const Rectangle &damage);
+        void resetItems();
+        void uploadDrawList(DrawList *drawList);
         void storeState();
         void restoreState();
         void checkVertexBuffer(size_t numRequiredVertices);
-        void checkIndexBuffer(size_t numRequiredIndices);
+        void checkIndexBuffer(size_t numRequiredBytes);
         void checkItemBuffer(size_t numRequiredItems);
         void checkTemporaryVertexBuffer(size_t numRequiredVertices);
         void checkTemporaryIndexBuffer(size_t numRequiredIndices);
         void addVertices(const DrawCommand *command);
-        void rotateVertices(Vertex *vertices, size_t numVertices, float angleDegrees);
+        Rectangle getEffectiveClip(const Rectangle &clippingRect) const;
+        bool clipQuads(const DrawCommand *command, const Rectangle &clippingRect, DrawCommand &clipped);
+        void addInstance(const InstanceData &instance, uint32_t textureId, const Rectangle &clippingRect, void *userData);
+        void addShape(const Vector2 &position, const Vector2 &size, float rotationDegrees, const Color &color, const Vector2 &shape, const Rectangle &clippingRect, void *userData);
+        InstanceData *addInstances(size_t count, uint32_t textureId, const Rectangle &bounds, const Rectangle &clippingRect);
+        void checkInstanceBuffer(size_t numRequiredInstances);
+        void setInstanceAttributes(uint32_t instanceBuffer, size_t instanceOffset);
+        void setVertexAttributes(VertexFormat format);
+        void packVertices(const Vertex *source, size_t numVertices, CompactVertex *destination);
+        void beginFrameStats();
+        void endFrameStats(const std::chrono::steady_clock::time_point &submitStart);
+        void readTimerQueries();
         void createBuffers();
+        void reallocateBuffers(BufferUploadMode mode, size_t numVertices, size_t numIndexBytes);
+        void releaseBuffers();
+        void unmapRingBuffer();
+        bool mapRingRegion(size_t firstVertex = 0, size_t firstIndexByte = 0);
+        void unmapRingRegion();
+        void advanceRingRegion();
+        void updateFrameUniforms();
+        uint32_t createProgram(const std::string &vertexSource, const std::string &fragmentSource);
         void createShader();
+        void createFrameUniformBuffer();
+        void createInstanceBuffers();
+        void createInstanceShader();
+        void createPlotShader();
         void createTexture();
     };
 };
@@ -0,0 +1,80 @@
+#ifndef VEXED_NULLBACKEND_H
+#define VEXED_NULLBACKEND_H
+
+#include "backend.h"
+#include <vector>
+#include <unordered_map>
+
+namespace vexed {
+    enum BackendCommandType {
+        BackendCommandType_CreateBuffer,
+        BackendCommandType_DestroyBuffer,
+        BackendCommandType_AllocateBuffer,
+        BackendCommandType_UpdateBuffer,
+        BackendCommandType_MapBuffer,
+        BackendCommandType_CopyBuffer,
+        BackendCommandType_CreateTexture,
+        BackendCommandType_UpdateTexture,
+        BackendCommandType_DestroyTexture,
+        BackendCommandType_CreateFramebuffer,
+        BackendCommandType_DestroyFramebuffer,
+        BackendCommandType_CreateProgram,
+        BackendCommandType_DestroyProgram,
+        BackendCommandType_Submit
+    };
+
+    struct BackendCommand {
+        BackendCommandType type;
+        uint32_t id; //Buffer, texture, framebuffer or program, 0 for submissions
+        size_t bytes; //Written by the command, for submissions the number of indices or vertices
+    };
+
+    // Runs everything without a context, for benchmarks and tests of the CPU side in environments without a display
+    // Resource commands are recorded and the bytes they would send to the GPU are counted, mapped buffers are backed by memory
+    // that is thrown away. Only resources and draws go through the backend, vertex layouts, uniforms, queries, framebuffer
+    // bindings and clears are still plain GL calls. Activating it replaces those entry points of the loader with functions
+    // that do nothing, which is process wide, so it must not be active while another thread renders with a real context
+    // Deactivating it puts the previous entry points back
+    class NullBackend : public Backend {
+    public:
+        NullBackend();
+        BackendType getType() const override { return BackendType_Null; }
+        void activate() override;
+        void deactivate() override;
+        uint32_t createBuffer() override;
+        void destroyBuffer(uint32_t buffer) override;
+        void allocateBuffer(uint32_t buffer, size_t size, const void *data, BufferUsage usage) override;
+        bool supportsPersistentMapping() const override { return true; }
+        void allocatePersistentBuffer(uint32_t buffer, size_t size) override;
+        void updateBuffer(uint32_t buffer, size_t offset, size_t size, const void *data) override;
+        void *mapBuffer(uint32_t buffer, size_t offset, size_t size, MapMode mode) override;
+        void unmapBuffer(uint32_t buffer) override;
+        void copyBuffer(uint32_t source, uint32_t destination, size_t sourceOffset, size_t destinationOffset, size_t size) override;
+        uint32_t createTexture(const TextureDescription &description) override;
+        void updateTexture(uint32_t texture, uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint32_t channels, const void *data) override;
+        void destroyTexture(uint32_t texture) override;
+        uint32_t createFramebuffer(uint32_t texture) override;
+        void destroyFramebuffer(uint32_t framebuffer) override;
+        uint32_t createProgram(const std::string &vertexSource, const std::string &fragmentSource) override;
+        void destroyProgram(uint32_t program) override;
+        void submit(const DrawSubmission &submission) override;
+        inline const std::vector<BackendCommand> &getCommands() const { return commands; }
+        inline size_t getUploadedBytes() const { return uploadedBytes; }
+        inline size_t getSubmissions() const { return numSubmissions; }
+        inline bool isRecording() const { return recording; }
+        inline void setRecording(bool enabled) { recording = enabled; } //When disabled only the counters are kept up to date
+        void clear(); //Forgets the recorded commands and resets the counters
+    private:
+        std::vector<BackendCommand> commands;
+        std::unordered_map<uint32_t, std::vector<uint8_t>> storage; //Memory behind mapped buffers
+        std::unordered_map<uint32_t, size_t> bufferSizes;
+        uint32_t nextName;
+        size_t uploadedBytes;
+        size_t numSubmissions;
+        bool recording;
+        bool active;
+        void record(BackendCommandType type, uint32_t id, size_t bytes);
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef VEXED_PLOTBUFFER_H
+#define VEXED_PLOTBUFFER_H
+
+#include "graphics.h"
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+namespace vexed {
+    // A ring of samples that lives in a buffer texture, Graphics::addPlotBuffer draws it by fetching the samples in the vertex shader
+    // Appended samples are staged on the CPU and only those are uploaded the next time the buffer is drawn
+    class PlotBuffer {
+    friend class Graphics;
+    public:
+        PlotBuffer();
+        bool create(size_t capacity); //Needs a current context, the capacity is the number of samples that are kept
+        void destroy();
+        void append(float value);
+        void append(const float *values, size_t count);
+        void clear();
+        inline bool isValid() const { return texture > 0; }
+        inline size_t getCapacity() const { return capacity; }
+        inline size_t getCount() const { return count; }
+        inline size_t getUploadedBytes() const { return uploadedBytes; } //Bytes sent by the last upload
+    private:
+        uint32_t buffer;
+        uint32_t texture;
+        size_t capacity;
+        size_t head; //Ring index the next sample is written to
+        size_t count;
+        size_t uploadedBytes;
+        uint64_t revision; //Changes with every append or clear
+        std::vector<float> pending; //Samples appended since the last upload, the newest last
+        void upload();
+        inline size_t getStart() const { return (head + capacity - count) % capacity; } //Ring index of the oldest sample
+    };
+}
+
+#endif
\ No newline at end of file
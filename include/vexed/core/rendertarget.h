@@ -0,0 +1,33 @@
+#ifndef VEXED_RENDERTARGET_H
+#define VEXED_RENDERTARGET_H
+
+#include "graphics.h"
+#include "drawlist.h"
+#include <cstdint>
+
+namespace vexed {
+    // A texture that is drawn into instead of the screen. Everything added between Graphics::beginRenderTarget and
+    // Graphics::endRenderTarget is recorded and rendered into the texture at the start of the next frame, the texture keeps
+    // its content until the target is recorded again, so Graphics::addRenderTarget can show it any number of frames later
+    // Colors in the texture are premultiplied by their alpha
+    class RenderTarget {
+    friend class Graphics;
+    public:
+        RenderTarget();
+        bool create(uint32_t width, uint32_t height); //Needs a current context, recreates the texture when the size changes
+        void destroy();
+        inline bool isValid() const { return framebuffer > 0; }
+        inline uint32_t getTextureId() const { return texture; }
+        inline uint32_t getWidth() const { return width; }
+        inline uint32_t getHeight() const { return height; }
+    private:
+        uint32_t framebuffer;
+        uint32_t texture;
+        uint32_t width;
+        uint32_t height;
+        Vector2 origin; //Screen position that maps to the top left corner of the texture while recording
+        DrawList drawList;
+    };
+}
+
+#endif
\ No newline at end of file
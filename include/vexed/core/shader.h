@@ -2,8 +2,19 @@
 #include <string>
 
 namespace vexed {
+    // Programs that declare the frame uniform block get it bound to FRAME_UNIFORM_BINDING when loaded
+    // The block is updated once per frame by Graphics and has to be declared as follows:
+    //
+    // layout(std140) uniform VexedFrame {
+    //     mat4 uProjection;
+    //     vec4 uViewport;
+    //     float uTime;
+    // };
+    //
+    // Plain uProjection and uTime uniforms outside of the block still get their values from Graphics, with a warning when loaded
     class Shader {
     public:
+        static constexpr uint32_t FRAME_UNIFORM_BINDING = 0;
         Shader();
         inline uint32_t getId() const { return id; }
         bool load(const std::string &vertexSource, const std::string &fragmentSource);
@@ -11,9 +22,8 @@ namespace vexed {
         void destroy();
         void setFloat(const char *name, float value);
         void setFloat2(const char *name, const float *value);
+        static void bindFrameUniforms(uint32_t programId);
     private:
         uint32_t id;
-        static bool checkShader(uint32_t handle, const std::string &description);
-        static bool checkProgram(uint32_t handle, const std::string &description);
     };
 }
\ No newline at end of file
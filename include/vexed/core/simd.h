@@ -0,0 +1,30 @@
+#ifndef VEXED_SIMD_H
+#define VEXED_SIMD_H
+
+#include "graphics.h"
+#include <cstdint>
+#include <cstdlib>
+
+namespace vexed {
+    enum SimdLevel {
+        SimdLevel_Scalar,
+        SimdLevel_SSE2,
+        SimdLevel_AVX2,
+        SimdLevel_NEON
+    };
+
+    // Vertex generation kernels, the best implementation the CPU supports is picked the first time one of them is used
+    class Simd {
+    public:
+        static SimdLevel getLevel();
+        static SimdLevel getSupportedLevel();
+        static bool setLevel(SimdLevel level); //Not thread safe, meant to be called before rendering starts
+        static const char *getLevelName(SimdLevel level);
+        static void fillColor(Vertex *vertices, size_t numVertices, const Color &color);
+        static void rotateVertices(Vertex *vertices, size_t numVertices, float angleDegrees); //Around the centroid of the vertices
+        static void extrudeSegments(const Vector2 *segments, size_t count, float thickness, const Color &color, Vertex *quads); //Writes 4 vertices per pair of points
+        static void expandRectangles(const Rectangle *rectangles, size_t count, const Color &color, Vertex *quads); //Writes 4 vertices per rectangle
+    };
+}
+
+#endif
\ No newline at end of file
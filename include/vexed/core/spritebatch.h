@@ -0,0 +1,49 @@
+#ifndef VEXED_SPRITEBATCH_H
+#define VEXED_SPRITEBATCH_H
+
+#include "graphics.h"
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+namespace vexed {
+    class Atlas;
+
+    enum SpriteSortMode {
+        SpriteSortMode_Deferred, //Submission order
+        SpriteSortMode_Texture, //Grouped by texture, submission order within a texture
+        SpriteSortMode_BackToFront, //Highest depth first
+        SpriteSortMode_FrontToBack //Lowest depth first
+    };
+
+    // Collects sprites between 'begin' and 'end' and hands them to Graphics as instanced runs, one item per texture change
+    // Sprites are kept as separate arrays per attribute, so sorting only has to touch the keys
+    class SpriteBatch {
+    public:
+        SpriteBatch();
+        void begin(SpriteSortMode sortMode = SpriteSortMode_Deferred, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0));
+        void draw(uint32_t textureId, const Vector2 &position, const Vector2 &size, const Rectangle &source = Rectangle(0, 0, 1, 1), float rotationDegrees = 0.0f, const Color &tint = Color(1, 1, 1, 1), float depth = 0.0f); //Source is in texture coordinates
+        void draw(const Atlas *atlas, uint32_t regionHandle, const Vector2 &position, const Vector2 &size, float rotationDegrees = 0.0f, const Color &tint = Color(1, 1, 1, 1), float depth = 0.0f);
+        void end(Graphics *graphics);
+        inline size_t getNumberOfSprites() const { return textureIds.size(); }
+        inline size_t getNumberOfBatches() const { return numBatches; } //Texture runs handed to Graphics by the last 'end'
+    private:
+        std::vector<uint32_t> textureIds;
+        std::vector<float> depths;
+        std::vector<Vector2> positions;
+        std::vector<Vector2> sizes;
+        std::vector<Vector2> uv0s;
+        std::vector<Vector2> uv1s;
+        std::vector<uint32_t> colors; //RGBA8
+        std::vector<float> rotations; //Radians
+        std::vector<uint64_t> keys; //Sort key in the upper, sprite index in the lower 32 bits
+        std::vector<uint64_t> scratch;
+        SpriteSortMode sortMode;
+        Rectangle clippingRect;
+        size_t numBatches;
+        bool active;
+        void sort();
+    };
+}
+
+#endif
\ No newline at end of file
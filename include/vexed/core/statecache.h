@@ -0,0 +1,68 @@
+#ifndef VEXED_STATECACHE_H
+#define VEXED_STATECACHE_H
+
+#include <cstdint>
+#include <cstdlib>
+
+namespace vexed {
+    enum BufferTarget {
+        BufferTarget_Array,
+        BufferTarget_ElementArray,
+        BufferTarget_Uniform,
+        BufferTarget_COUNT
+    };
+
+    // Shadows the OpenGL state that Graphics touches, so calls are only issued when the value actually changes
+    // Anything that modifies this state behind the back of the cache must be followed by a call to 'invalidate'
+    class StateCache {
+    public:
+        StateCache();
+        void invalidate();
+        void invalidateTexture();
+        void setBlend(bool enabled);
+        void setBlendFunc(int32_t sourceFactor, int32_t destinationFactor);
+        void setBlendFuncSeparate(int32_t sourceFactor, int32_t destinationFactor, int32_t sourceAlphaFactor, int32_t destinationAlphaFactor);
+        void setBlendEquation(int32_t equation);
+        void setDepthTest(bool enabled);
+        void setDepthFunc(int32_t func);
+        void setScissorTest(bool enabled);
+        void setScissor(int32_t x, int32_t y, int32_t width, int32_t height);
+        void useProgram(uint32_t id);
+        void setActiveTexture(uint32_t unit);
+        void bindTexture(uint32_t id);
+        void bindVertexArray(uint32_t id);
+        void bindBuffer(uint32_t target, uint32_t id);
+        inline size_t getIssuedChanges() const { return numIssued; }
+        inline size_t getSkippedChanges() const { return numSkipped; }
+        inline size_t getProgramChanges() const { return numProgramChanges; }
+        inline size_t getTextureChanges() const { return numTextureChanges; }
+        inline size_t getScissorChanges() const { return numScissorChanges; } //Includes toggling the scissor test
+        void resetCounters();
+    private:
+        static constexpr int64_t UNKNOWN = -1;
+        int64_t blend;
+        int64_t blendSourceFactor;
+        int64_t blendDestinationFactor;
+        int64_t blendSourceAlphaFactor;
+        int64_t blendDestinationAlphaFactor;
+        int64_t blendEquation;
+        int64_t depthTest;
+        int64_t depthFunc;
+        int64_t scissorTest;
+        int64_t scissor[4];
+        int64_t program;
+        int64_t activeTexture;
+        int64_t texture;
+        int64_t vertexArray;
+        int64_t buffers[BufferTarget_COUNT];
+        size_t numIssued;
+        size_t numSkipped;
+        size_t numProgramChanges;
+        size_t numTextureChanges;
+        size_t numScissorChanges;
+        bool update(int64_t &current, int64_t value);
+        static BufferTarget getBufferTarget(uint32_t target);
+    };
+}
+
+#endif
\ No newline at end of file
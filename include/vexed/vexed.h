@@ -2,12 +2,23 @@
 #define VEXED_H_
 
 #include "core/application.h"
+#include "core/atlas.h"
+#include "core/backend.h"
+#include "core/commandbuffer.h"
+#include "core/drawlist.h"
 #include "core/font.h"
+#include "core/frametimestats.h"
+#include "core/glbackend.h"
 #include "core/graphics.h"
 #include "core/image.h"
 #include "core/keyboard.h"
 #include "core/mouse.h"
+#include "core/nullbackend.h"
+#include "core/plotbuffer.h"
+#include "core/rendertarget.h"
 #include "core/shader.h"
+#include "core/simd.h"
+#include "core/spritebatch.h"
 #include "core/texture.h"
 
 #endif
\ No newline at end of file
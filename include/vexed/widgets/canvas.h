@@ -16,7 +16,11 @@ namespace vexed {
         void onRender() override;
     private:
         Widget* stack[WORKING_STATIC_SIZE];
+        Rectangle clips[WORKING_STATIC_SIZE]; //Clip inherited by the widget at the same index of the stack
         void checkEvents(Widget *widget);
+        bool needsLayerUpdate(Widget *widget) const;
+        bool beginLayer(Widget *widget);
+        void addLayer(Widget *widget, const Rectangle &clip);
         void onCharPressCallback(uint32_t codepoint);
         void onKeyDownCallback(KeyCode keycode);
         void onKeyUpCallback(KeyCode keycode);
@@ -16,6 +16,7 @@ namespace vexed {
         void setSelectedIndex(uint32_t index);
     protected:
         void onRender() override;
+        void onRenderOverlay() override;
         void onButtonDown(ButtonCode buttoncode) override;
         void onButtonUp(ButtonCode buttoncode) override;
         void onMouseEnter() override;
@@ -16,6 +16,7 @@ namespace vexed {
         float blinkInterval;
         float lastKeyStroke;
         void resetLastKeyStroke();
+        bool updateBlink(); //Whether the cursor is shown this frame, also schedules the frame that changes it
         size_t getCursorIndex() const;
         void setCursorIndex(size_t index, size_t textSize);
         void getCursorPosition(const std::string &text, size_t &row, size_t &column) const;
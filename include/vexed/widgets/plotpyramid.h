@@ -0,0 +1,39 @@
+#ifndef VEXED_PLOTPYRAMID_H
+#define VEXED_PLOTPYRAMID_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+namespace vexed {
+    struct PlotBucket {
+        float min;
+        float max;
+        float mean;
+        uint32_t count; //Samples that are not NaN
+    };
+
+    // Keeps a growing series together with a decimation pyramid over it, every level summarizes BRANCHING buckets of the level
+    // below, so the min, max and mean of any range can be found by visiting a few buckets per level
+    // A query walks the widest buckets that fit in the range, so a range of one pixel column automatically reads the level
+    // matching the pixel density
+    // Only complete buckets are stored, appending a sample adds at most one bucket per level
+    class PlotPyramid {
+    public:
+        static constexpr size_t BRANCHING = 8;
+        PlotPyramid();
+        void append(float value);
+        void append(const float *values, size_t count);
+        void clear();
+        bool query(size_t begin, size_t end, PlotBucket &result) const; //Exact for the samples in [begin, end), false when none of them is a number
+        inline size_t getCount() const { return samples.size(); }
+        inline float getSample(size_t index) const { return samples[index]; }
+        inline size_t getNumberOfLevels() const { return levels.size(); }
+    private:
+        std::vector<float> samples;
+        std::vector<std::vector<PlotBucket>> levels; //Level 0 summarizes BRANCHING samples per bucket
+        void updateLevels();
+    };
+}
+
+#endif
\ No newline at end of file
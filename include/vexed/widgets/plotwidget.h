@@ -0,0 +1,55 @@
+#ifndef VEXED_PLOTWIDGET_H
+#define VEXED_PLOTWIDGET_H
+
+#include "widget.h"
+#include "plotpyramid.h"
+
+namespace vexed {
+    struct PlotSeries {
+        PlotPyramid pyramid;
+        Color color;
+    };
+
+    // Plots one or more series, every pixel column shows the min/max band and the mean of the samples it covers
+    // The mouse wheel zooms around the cursor and dragging pans, the view keeps following new samples while it shows the end
+    class PlotWidget : public Widget {
+    public:
+        PlotWidget();
+        size_t addSeries(const Color &color);
+        void append(size_t series, float value);
+        void append(size_t series, const float *values, size_t count);
+        void clear();
+        size_t getNumberOfSeries() const;
+        size_t getNumberOfSamples() const; //Of the longest series
+        void setView(double start, double length); //In samples
+        void fitView();
+        double getViewStart() const;
+        double getViewLength() const;
+        void setValueRange(float min, float max); //Disables the automatic range
+        void setAutoRange(bool enabled); //Fits the value range to the visible samples
+        void setThickness(float thickness);
+    protected:
+        void onRender() override;
+        void onButtonDown(ButtonCode buttoncode) override;
+        void onButtonUp(ButtonCode buttoncode) override;
+        void onMouseEnter() override;
+        void onMouseLeave() override;
+    private:
+        std::vector<PlotSeries> series;
+        std::vector<Vector2> points;
+        std::vector<Rectangle> bands;
+        double viewStart;
+        double viewLength;
+        float valueMin;
+        float valueMax;
+        float thickness;
+        bool autoRange;
+        bool fitting; //The view grows with the series until it is zoomed or panned
+        bool following;
+        void updateView();
+        void updateValueRange(size_t begin, size_t end);
+        void renderSeries(const PlotSeries &plotSeries, const Rectangle &rect);
+    };
+}
+
+#endif
\ No newline at end of file
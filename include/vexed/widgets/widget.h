@@ -40,6 +40,7 @@ namespace vexed {
         WidgetColor_ComboboxRowSelected,
         WidgetColor_ContainerBackground,
         WidgetColor_LabelNormal,
+        WidgetColor_PlotBackground,
         WidgetColor_SliderNormal,
         WidgetColor_SliderHovered,
         WidgetColor_SliderFocused,
@@ -86,6 +87,11 @@ namespace vexed {
         uint32_t getShader() const;
         void setShader(uint32_t shaderId);
         void remove(const Widget *widget);
+        bool getClipChildren() const { return clipChildren; }
+        void setClipChildren(bool enabled); //Children are only drawn inside of this widget
+        bool isLayered() const { return layered; }
+        void setLayered(bool enabled); //Draws the widget and its children into a cached texture, see markDirty
+        void markDirty(); //The layers this widget is drawn into are redrawn in the next frame
 
         template <typename T, typename... Param>
         T* add(Param... param) {
@@ -100,6 +106,7 @@ namespace vexed {
             Widget *widget = children[last].get();
             widget->transform.setParent(&transform);
             widget->parent = this;
+            markDirty();
 
             return static_cast<T*>(widget);
         }
@@ -114,9 +121,15 @@ namespace vexed {
         void addTriangle(const Vector2 &position, const Vector2 &size, float rotationDegrees, const Color &color, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0), uint32_t shaderId = 0);
         void addText(const Vector2 &position, Font *font, bool richText, const std::string &text, float fontSize, const Color &color, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0));
         void addLines(Vector2 *segments, size_t count, float thickness, const Color &color, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0));
+        void addPolyline(const Vector2 *points, size_t count, float thickness, const Color &color, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0));
+        void addRectangles(const Rectangle *rectangles, size_t count, const Color &color, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0));
         void addBorder(const Vector2 &position, const Vector2 &size, float thickness, const Color &color, BorderOptions borderOptions, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0));
+        int32_t getLayer() const;
+        void setLayer(int32_t layer);
+        void setOverlay(bool enabled); //Calls onRenderOverlay after every widget is drawn, outside of any clip or layer
         virtual bool containsPoint(const Vector2 &point);
         virtual void onRender() {}
+        virtual void onRenderOverlay() {} //For popups that have to cover their siblings
         virtual void onCharPress(uint32_t codepoint) {}
         virtual void onKeyDown(KeyCode keycode) {}
         virtual void onKeyUp(KeyCode keycode) {}
@@ -136,7 +149,13 @@ namespace vexed {
         std::vector<std::unique_ptr<Widget>> children;
         Color colors[WidgetColor_COUNT];
         uint32_t shaderId;
+        bool clipChildren;
+        bool layered;
+        bool layerDirty;
+        bool overlay;
+        RenderTarget layerTarget;
         static Widget *focusedWidget;
+        static std::vector<Widget*> overlayWidgets;
     };
 }
 
@@ -3,12 +3,18 @@
 #include "../../glad/glad.h"
 #include "../../glfw/glfw3.h"
 #include <iostream>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <thread>
 
 namespace vexed {
     Application *Application::instance = nullptr;
 
     Application::Application() 
-        : window(nullptr), monitor(nullptr) {
+        : window(nullptr), monitor(nullptr), redrawRequested(false), nextAnimationFrame(std::numeric_limits<float>::infinity()),
+          fixedTimeStep(0.0f), maxFixedSteps(8), fixedTimeAccumulator(0.0f), interpolationAlpha(0.0f), frameRateLimit(0.0f),
+          sleepOvershoot(std::chrono::milliseconds(1)) {
         config.title = "Vexed";
         config.width = 512;
         config.height = 512;
@@ -19,7 +25,9 @@ namespace vexed {
     }
 
     Application::Application(const Configuration &config) 
-        : config(config), window(nullptr), monitor(nullptr) {
+        : config(config), window(nullptr), monitor(nullptr), redrawRequested(false), nextAnimationFrame(std::numeric_limits<float>::infinity()),
+          fixedTimeStep(0.0f), maxFixedSteps(8), fixedTimeAccumulator(0.0f), interpolationAlpha(0.0f), frameRateLimit(0.0f),
+          sleepOvershoot(std::chrono::milliseconds(1)) {
         instance = this;
     }
     
@@ -82,7 +90,15 @@ namespace vexed {
             }
         }
 
-        glfwSwapInterval(config.flags & WindowFlags_VSync);
+        int swapInterval = (config.flags & WindowFlags_VSync) ? 1 : 0;
+
+        // A negative interval needs the tear control extension of the platform
+        if(config.flags & WindowFlags_AdaptiveVSync) {
+            const bool tearControl = glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear");
+            swapInterval = tearControl ? -1 : 1;
+        }
+
+        glfwSwapInterval(swapInterval);
 
         glfwSetWindowUserPointer(window, this);
         glfwSetFramebufferSizeCallback(window, onFramebufferResize);
@@ -91,6 +107,7 @@ namespace vexed {
         glfwSetMouseButtonCallback(window, onMouseButtonPress);
         glfwSetScrollCallback(window, onMouseScroll);
         glfwSetWindowPosCallback(window, onWindowPos);
+        glfwSetWindowRefreshCallback(window, onWindowRefresh);
 
         graphics.initialize();
         graphics.setClearColor(Color(0, 0, 0, 1));
@@ -107,9 +124,28 @@ namespace vexed {
         float elapsedTime = 0.0f;
         int fps = 0;
 
+        // A skipped frame does not swap, so vsync no longer paces the loop and it waits for input for a refresh instead
+        const GLFWvidmode *videoMode = glfwGetVideoMode(monitor);
+        const double refreshInterval = 1.0 / ((videoMode && videoMode->refreshRate > 0) ? videoMode->refreshRate : 60);
+
+        nextFrameTime = std::chrono::steady_clock::now();
+
+        // Unless the application set its own budget, a frame is over budget when it misses the frame rate limit or the refresh
+        // Paced frames jitter around the interval, so only a frame that takes half an interval longer counts as missed
+        if(frameTimeStats.getBudget() <= 0.0)
+            frameTimeStats.setBudget(1.5 * (frameRateLimit > 0.0f ? 1000.0 / frameRateLimit : refreshInterval * 1000.0));
+
+        using Milliseconds = std::chrono::duration<double, std::milli>;
+
         while (!glfwWindowShouldClose(window)) {
             timer.update();
 
+            const auto frameStart = timer.tp1;
+
+            // Whatever is requested from here on is for the frames after this one
+            redrawRequested = false;
+            nextAnimationFrame = std::numeric_limits<float>::infinity();
+
             //Cursor pos callback is not called when mouse is outside the bounds of the window
             //This causes rectangle tests to report false positives when they are on any edge of the window
             //and the mouse is outside of bounds.
@@ -128,15 +164,46 @@ namespace vexed {
             keyboard.newFrame();
             mouse.newFrame();
 
+            if(fixedTimeStep > 0.0f)
+                runFixedUpdates();
+
             if(update)
                 update(this);
 
-            graphics.newFrame(timer.deltaTime);
+            const auto updateEnd = std::chrono::steady_clock::now();
+
+            const bool drawn = graphics.newFrame(timer.deltaTime);
 
             mouse.endFrame();
-            
-            glfwSwapBuffers(window);
-            glfwPollEvents();
+
+            const auto renderEnd = std::chrono::steady_clock::now();
+
+            if(drawn)
+                glfwSwapBuffers(window);
+
+            const auto swapEnd = std::chrono::steady_clock::now();
+
+            if(frameRateLimit > 0.0f)
+                limitFrameRate();
+
+            // Sleeping until something happens is idle time, not a slow frame
+            auto idleTime = std::chrono::steady_clock::duration::zero();
+
+            if(config.flags & WindowFlags_OnDemand) {
+                const auto waitStart = std::chrono::steady_clock::now();
+                waitEvents();
+                idleTime = std::chrono::steady_clock::now() - waitStart;
+            } else if(drawn) {
+                glfwPollEvents();
+            } else {
+                glfwWaitEventsTimeout(refreshInterval);
+            }
+
+            frameTimeStats.addFrame(
+                Milliseconds(std::chrono::steady_clock::now() - frameStart - idleTime).count(),
+                Milliseconds(updateEnd - frameStart).count(),
+                Milliseconds(renderEnd - updateEnd).count(),
+                Milliseconds(swapEnd - renderEnd).count());
         }
 
         if(close)
@@ -148,6 +215,102 @@ namespace vexed {
         glfwTerminate();
     }
 
+    void Application::setFixedTimeStep(float seconds, uint32_t maxStepsPerFrame) {
+        fixedTimeStep = std::max(seconds, 0.0f);
+        maxFixedSteps = std::max<uint32_t>(maxStepsPerFrame, 1);
+        fixedTimeAccumulator = 0.0f;
+        interpolationAlpha = 0.0f;
+    }
+
+    void Application::setFrameRateLimit(float framesPerSecond) {
+        frameRateLimit = std::max(framesPerSecond, 0.0f);
+        nextFrameTime = std::chrono::steady_clock::now();
+    }
+
+    // Input is updated once per frame, so every step of a frame sees the same keyboard and mouse state
+    // When the steps can not keep up the time that is left over is dropped, otherwise every frame would have to run more steps
+    void Application::runFixedUpdates() {
+        fixedTimeAccumulator += timer.deltaTime;
+
+        uint32_t steps = 0;
+
+        while(fixedTimeAccumulator >= fixedTimeStep && steps < maxFixedSteps) {
+            if(fixedUpdate)
+                fixedUpdate(this);
+            fixedTimeAccumulator -= fixedTimeStep;
+            steps++;
+        }
+
+        if(fixedTimeAccumulator >= fixedTimeStep)
+            fixedTimeAccumulator = std::fmod(fixedTimeAccumulator, fixedTimeStep);
+
+        interpolationAlpha = fixedTimeAccumulator / fixedTimeStep;
+    }
+
+    // Frames end on a fixed cadence. Most of the wait is slept, the last part is spun because the thread may wake up late,
+    // the margin follows how late it actually woke up before
+    void Application::limitFrameRate() {
+        using Clock = std::chrono::steady_clock;
+
+        const auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / frameRateLimit));
+
+        nextFrameTime += interval;
+
+        auto now = Clock::now();
+
+        // Too far behind to catch up, start the cadence over instead of running frames back to back
+        if(nextFrameTime <= now) {
+            nextFrameTime = now;
+            return;
+        }
+
+        const auto remaining = nextFrameTime - now;
+
+        if(remaining > sleepOvershoot) {
+            const auto sleepTime = remaining - sleepOvershoot;
+            std::this_thread::sleep_for(sleepTime);
+
+            const auto overshoot = (Clock::now() - now) - sleepTime;
+            sleepOvershoot = std::max<Clock::duration>(overshoot, (sleepOvershoot * 15) / 16);
+            sleepOvershoot = std::max<Clock::duration>(sleepOvershoot, std::chrono::microseconds(200));
+        }
+
+        while(Clock::now() < nextFrameTime)
+            std::this_thread::yield();
+    }
+
+    void Application::requestRedraw() {
+        redrawRequested = true;
+
+        // Wakes up the loop when it is waiting, a request from the loop itself is seen before it waits
+        if(window)
+            glfwPostEmptyEvent();
+    }
+
+    void Application::requestAnimationFrame(float time) {
+        nextAnimationFrame = std::min(nextAnimationFrame, time);
+    }
+
+    // Sleeps until there is input, a redraw was requested or the earliest requested animation frame is due
+    void Application::waitEvents() {
+        if(redrawRequested) {
+            glfwPollEvents();
+            return;
+        }
+
+        if(std::isinf(nextAnimationFrame)) {
+            glfwWaitEvents();
+            return;
+        }
+
+        const float now = timer.elapsedTime + std::chrono::duration<float>(std::chrono::steady_clock::now() - timer.tp1).count();
+
+        if(nextAnimationFrame > now)
+            glfwWaitEventsTimeout(nextAnimationFrame - now);
+        else
+            glfwPollEvents();
+    }
+
     void Application::onFramebufferResize(GLFWwindow* window, int width, int height) {
         void *userData = glfwGetWindowUserPointer(window);
         if(userData) {
@@ -156,6 +319,16 @@ namespace vexed {
         }
     }
 
+    // The content was lost, for example while the window was being resized or uncovered
+    void Application::onWindowRefresh(GLFWwindow *window) {
+        void *userData = glfwGetWindowUserPointer(window);
+        if(userData) {
+            Application *application = reinterpret_cast<Application*>(userData);
+            application->graphics.invalidate();
+            application->requestRedraw();
+        }
+    }
+
     void Application::onWindowPos(GLFWwindow *window, int xpos, int ypos) {
         void *userData = glfwGetWindowUserPointer(window);
         if(userData) {
@@ -0,0 +1,384 @@
+#include "atlas.h"
+#include "backend.h"
+#include "../../glad/glad.h"
+#include <algorithm>
+#include <iostream>
+
+namespace vexed {
+    Atlas::Atlas(uint32_t pageSize, uint32_t maxPageSize, uint32_t padding) {
+        this->pageSize = pageSize;
+        this->maxPageSize = std::max(pageSize, maxPageSize);
+        this->padding = padding;
+        numRegions = 0;
+    }
+
+    uint32_t Atlas::add(const Image *image) {
+        if(!image || !image->isLoaded())
+            return INVALID_HANDLE;
+        return add(image->getData(), image->getWidth(), image->getHeight(), image->getChannels());
+    }
+
+    uint32_t Atlas::add(const uint8_t *data, uint32_t width, uint32_t height, uint32_t channels) {
+        if(!data || width == 0 || height == 0 || channels < 1 || channels > 4)
+            return INVALID_HANDLE;
+
+        const uint32_t paddedWidth = width + (padding * 2);
+        const uint32_t paddedHeight = height + (padding * 2);
+
+        if(paddedWidth > maxPageSize || paddedHeight > maxPageSize) {
+            std::cerr << "Failed to add image to atlas: " << width << "x" << height << " does not fit in a page of " << maxPageSize << "x" << maxPageSize << std::endl;
+            return INVALID_HANDLE;
+        }
+
+        Entry entry;
+        entry.page = 0;
+        entry.x = 0;
+        entry.y = 0;
+        entry.width = width;
+        entry.height = height;
+        entry.used = false; //Set once it has a place, so repacking a page to make room does not pick it up
+        entry.pixels.resize(width * height * 4);
+
+        // Pages are always RGBA, missing channels are expanded the same way glTexImage2D does
+        for(size_t i = 0; i < width * height; i++) {
+            const uint8_t *src = &data[i * channels];
+            uint8_t *dst = &entry.pixels[i * 4];
+            dst[0] = src[0];
+            dst[1] = channels > 1 ? src[1] : 0;
+            dst[2] = channels > 2 ? src[2] : 0;
+            dst[3] = channels > 3 ? src[3] : 255;
+        }
+
+        uint32_t handle;
+
+        if(freeHandles.size() > 0) {
+            handle = freeHandles.back();
+            freeHandles.pop_back();
+        } else {
+            entries.push_back(Entry());
+            handle = static_cast<uint32_t>(entries.size());
+        }
+
+        entries[handle - 1] = std::move(entry);
+        Entry &target = entries[handle - 1];
+
+        bool placed = false;
+
+        for(size_t i = 0; i < pages.size() && !placed; i++) {
+            placed = place(target, i);
+        }
+
+        // Grow an existing page before starting a new one, fewer pages means fewer texture switches
+        for(size_t i = pages.size(); i-- > 0 && !placed;) {
+            uint32_t newSize = pages[i].size * 2;
+            if(newSize <= maxPageSize && repack(i, newSize))
+                placed = place(target, i);
+        }
+
+        if(!placed) {
+            uint32_t size = pageSize;
+            while(size < paddedWidth || size < paddedHeight)
+                size *= 2;
+            placed = place(target, createPage(std::min(size, maxPageSize)));
+        }
+
+        if(!placed) {
+            std::cerr << "Failed to add image to atlas" << std::endl;
+            target.pixels = std::vector<uint8_t>();
+            freeHandles.push_back(handle);
+            return INVALID_HANDLE;
+        }
+
+        target.used = true;
+        numRegions++;
+        return handle;
+    }
+
+    bool Atlas::remove(uint32_t handle) {
+        if(handle == INVALID_HANDLE || handle > entries.size())
+            return false;
+
+        Entry &entry = entries[handle - 1];
+
+        if(!entry.used)
+            return false;
+
+        Page &page = pages[entry.page];
+        page.freedArea += (entry.width + (padding * 2)) * (entry.height + (padding * 2));
+
+        entry.used = false;
+        entry.pixels = std::vector<uint8_t>();
+        freeHandles.push_back(handle);
+        numRegions--;
+
+        // The skyline can not give space back, so the page is repacked once half of it is unused
+        if(page.freedArea * 2 > page.usedArea)
+            repack(entry.page, page.size);
+
+        return true;
+    }
+
+    bool Atlas::getRegion(uint32_t handle, AtlasRegion &region) const {
+        if(handle == INVALID_HANDLE || handle > entries.size())
+            return false;
+
+        const Entry &entry = entries[handle - 1];
+
+        if(!entry.used)
+            return false;
+
+        const Page &page = pages[entry.page];
+        const float size = static_cast<float>(page.size);
+
+        region.textureId = page.textureId;
+        region.uv0 = Vector2((entry.x + padding) / size, (entry.y + padding) / size);
+        region.uv1 = Vector2((entry.x + padding + entry.width) / size, (entry.y + padding + entry.height) / size);
+        region.width = entry.width;
+        region.height = entry.height;
+        return true;
+    }
+
+    // Releases pages without regions and repacks pages that contain removed regions
+    void Atlas::defragment() {
+        std::vector<size_t> remap(pages.size());
+        std::vector<bool> pageUsed(pages.size(), false);
+
+        for(const Entry &entry : entries) {
+            if(entry.used)
+                pageUsed[entry.page] = true;
+        }
+
+        size_t count = 0;
+
+        for(size_t i = 0; i < pages.size(); i++) {
+            if(!pageUsed[i]) {
+                Backend::getInstance()->destroyTexture(pages[i].textureId);
+                continue;
+            }
+            remap[i] = count;
+            if(count != i)
+                pages[count] = std::move(pages[i]);
+            count++;
+        }
+
+        pages.resize(count);
+
+        for(Entry &entry : entries) {
+            if(entry.used)
+                entry.page = remap[entry.page];
+        }
+
+        for(size_t i = 0; i < pages.size(); i++) {
+            if(pages[i].freedArea > 0)
+                repack(i, pages[i].size);
+        }
+    }
+
+    void Atlas::destroy() {
+        for(Page &page : pages) {
+            if(page.textureId > 0)
+                Backend::getInstance()->destroyTexture(page.textureId);
+        }
+
+        pages.clear();
+        entries.clear();
+        freeHandles.clear();
+        numRegions = 0;
+    }
+
+    // Bottom left skyline packing, the position with the lowest top edge wins
+    bool Atlas::insert(Page &page, uint32_t width, uint32_t height, uint32_t &x, uint32_t &y) {
+        size_t bestIndex = SIZE_MAX;
+        uint32_t bestBottom = UINT32_MAX;
+        uint32_t bestWidth = UINT32_MAX;
+
+        for(size_t i = 0; i < page.skyline.size(); i++) {
+            uint32_t top;
+            if(!fit(page, i, width, height, top))
+                continue;
+            if(top + height < bestBottom || (top + height == bestBottom && page.skyline[i].width < bestWidth)) {
+                bestIndex = i;
+                bestBottom = top + height;
+                bestWidth = page.skyline[i].width;
+                x = page.skyline[i].x;
+                y = top;
+            }
+        }
+
+        if(bestIndex == SIZE_MAX)
+            return false;
+
+        page.skyline.insert(page.skyline.begin() + bestIndex, { x, y + height, width });
+
+        // Shrink or drop the nodes that are now covered by the new node
+        for(size_t i = bestIndex + 1; i < page.skyline.size(); i++) {
+            SkylineNode &previous = page.skyline[i - 1];
+            SkylineNode &node = page.skyline[i];
+
+            if(node.x >= previous.x + previous.width)
+                break;
+
+            uint32_t shrink = previous.x + previous.width - node.x;
+
+            if(shrink >= node.width) {
+                page.skyline.erase(page.skyline.begin() + i);
+                i--;
+            } else {
+                node.x += shrink;
+                node.width -= shrink;
+                break;
+            }
+        }
+
+        for(size_t i = 0; i + 1 < page.skyline.size(); i++) {
+            if(page.skyline[i].y == page.skyline[i + 1].y) {
+                page.skyline[i].width += page.skyline[i + 1].width;
+                page.skyline.erase(page.skyline.begin() + i + 1);
+                i--;
+            }
+        }
+
+        page.usedArea += width * height;
+        return true;
+    }
+
+    bool Atlas::fit(const Page &page, size_t index, uint32_t width, uint32_t height, uint32_t &y) const {
+        if(page.skyline[index].x + width > page.size)
+            return false;
+
+        int64_t widthLeft = width;
+        y = page.skyline[index].y;
+
+        for(size_t i = index; widthLeft > 0; i++) {
+            if(i >= page.skyline.size())
+                return false;
+            y = std::max(y, page.skyline[i].y);
+            if(y + height > page.size)
+                return false;
+            widthLeft -= page.skyline[i].width;
+        }
+
+        return true;
+    }
+
+    bool Atlas::place(Entry &entry, size_t pageIndex) {
+        uint32_t x, y;
+
+        if(!insert(pages[pageIndex], entry.width + (padding * 2), entry.height + (padding * 2), x, y))
+            return false;
+
+        entry.page = pageIndex;
+        entry.x = x;
+        entry.y = y;
+        upload(entry);
+        return true;
+    }
+
+    // Packs the regions of a page again from scratch, optionally into a bigger texture
+    // Tallest regions go first, which packs a lot better than the order in which they were added
+    bool Atlas::repack(size_t pageIndex, uint32_t newSize) {
+        std::vector<Entry*> regions;
+
+        for(Entry &entry : entries) {
+            if(entry.used && entry.page == pageIndex)
+                regions.push_back(&entry);
+        }
+
+        std::sort(regions.begin(), regions.end(), [] (const Entry *a, const Entry *b) {
+            if(a->height != b->height)
+                return a->height > b->height;
+            return a->width > b->width;
+        });
+
+        Page trial;
+        trial.textureId = 0;
+        trial.size = newSize;
+        trial.skyline.push_back({ 0, 0, newSize });
+        trial.usedArea = 0;
+        trial.freedArea = 0;
+
+        std::vector<uint32_t> positions(regions.size() * 2);
+
+        for(size_t i = 0; i < regions.size(); i++) {
+            if(!insert(trial, regions[i]->width + (padding * 2), regions[i]->height + (padding * 2), positions[i*2+0], positions[i*2+1]))
+                return false;
+        }
+
+        Page &page = pages[pageIndex];
+        page.skyline = std::move(trial.skyline);
+        page.usedArea = trial.usedArea;
+        page.freedArea = 0;
+
+        if(page.size != newSize) {
+            page.size = newSize;
+            allocatePageTexture(page);
+        }
+
+        for(size_t i = 0; i < regions.size(); i++) {
+            regions[i]->x = positions[i*2+0];
+            regions[i]->y = positions[i*2+1];
+            upload(*regions[i]);
+        }
+
+        return true;
+    }
+
+    size_t Atlas::createPage(uint32_t size) {
+        Page page;
+        page.textureId = 0;
+        page.size = size;
+        page.skyline.push_back({ 0, 0, size });
+        page.usedArea = 0;
+        page.freedArea = 0;
+
+        allocatePageTexture(page);
+
+        pages.push_back(std::move(page));
+        return pages.size() - 1;
+    }
+
+    // Mipmaps are not used because they would blend neighbouring regions together
+    // A page that grows gets a new texture, regions that were retrieved before refer to the old one (see AtlasRegion)
+    void Atlas::allocatePageTexture(Page &page) {
+        Backend *backend = Backend::getInstance();
+
+        if(page.textureId > 0)
+            backend->destroyTexture(page.textureId);
+
+        TextureDescription description;
+        description.width = page.size;
+        description.height = page.size;
+        description.channels = 4;
+        description.format = TextureFormat_RGBA8;
+        description.wrapS = GL_CLAMP_TO_EDGE;
+        description.wrapT = GL_CLAMP_TO_EDGE;
+        description.minFilter = GL_LINEAR;
+        description.magFilter = GL_LINEAR;
+        description.mipmaps = false;
+        description.data = nullptr;
+
+        page.textureId = backend->createTexture(description);
+    }
+
+    // The padding repeats the edge pixels of the image, so linear filtering never picks up a neighbouring region
+    void Atlas::upload(const Entry &entry) {
+        const uint32_t paddedWidth = entry.width + (padding * 2);
+        const uint32_t paddedHeight = entry.height + (padding * 2);
+        std::vector<uint8_t> block(paddedWidth * paddedHeight * 4);
+
+        for(uint32_t y = 0; y < paddedHeight; y++) {
+            uint32_t sourceY = std::min(entry.height - 1, static_cast<uint32_t>(std::max(0, static_cast<int32_t>(y) - static_cast<int32_t>(padding))));
+            for(uint32_t x = 0; x < paddedWidth; x++) {
+                uint32_t sourceX = std::min(entry.width - 1, static_cast<uint32_t>(std::max(0, static_cast<int32_t>(x) - static_cast<int32_t>(padding))));
+                const uint8_t *src = &entry.pixels[(sourceY * entry.width + sourceX) * 4];
+                uint8_t *dst = &block[(y * paddedWidth + x) * 4];
+                dst[0] = src[0];
+                dst[1] = src[1];
+                dst[2] = src[2];
+                dst[3] = src[3];
+            }
+        }
+
+        Backend::getInstance()->updateTexture(pages[entry.page].textureId, entry.x, entry.y, paddedWidth, paddedHeight, 4, block.data());
+    }
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#include "backend.h"
+#include "glbackend.h"
+
+namespace vexed {
+    Backend *Backend::instance = nullptr;
+
+    static GLBackend glBackend;
+
+    Backend *Backend::getInstance() {
+        return instance ? instance : &glBackend;
+    }
+
+    void Backend::setInstance(Backend *backend) {
+        Backend *previous = getInstance();
+        Backend *next = backend ? backend : &glBackend;
+
+        if(previous == next)
+            return;
+
+        previous->deactivate();
+        instance = backend;
+        next->activate();
+    }
+}
\ No newline at end of file
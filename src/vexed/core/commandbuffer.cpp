@@ -0,0 +1,224 @@
+#include "commandbuffer.h"
+#include "simd.h"
+#include <cmath>
+#include <algorithm>
+
+namespace vexed {
+    CommandBuffer::CommandBuffer() {
+        layer = 0;
+    }
+
+    void CommandBuffer::clear() {
+        vertices.clear();
+        indices.clear();
+        instances.clear();
+        commands.clear();
+        layer = 0;
+    }
+
+    static bool sameClippingRect(const Rectangle &a, const Rectangle &b) {
+        return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+    }
+
+    // Reserves room for quads at the end of the buffer, extending the last command when it is a run of quads with the same state
+    Vertex *CommandBuffer::addQuads(size_t numQuads, uint32_t textureId, const Rectangle &clippingRect, uint32_t shaderId, void *userData) {
+        const size_t vertexOffset = vertices.size();
+        vertices.resize(vertexOffset + (numQuads * 4));
+
+        if(commands.size() > 0) {
+            RecordedCommand &last = commands.back();
+            if(last.numIndices == 0 && last.numInstances == 0 && last.textureId == textureId && last.shaderId == shaderId && last.userData == userData &&
+               last.layer == layer && !last.textureIsFont && sameClippingRect(last.clippingRect, clippingRect)) {
+                last.numVertices += numQuads * 4;
+                return &vertices[vertexOffset];
+            }
+        }
+
+        RecordedCommand command;
+        command.vertexOffset = vertexOffset;
+        command.numVertices = numQuads * 4;
+        command.indexOffset = indices.size();
+        command.numIndices = 0;
+        command.instanceOffset = instances.size();
+        command.numInstances = 0;
+        command.textureId = textureId;
+        command.shaderId = shaderId;
+        command.textureIsFont = false;
+        command.clippingRect = clippingRect;
+        command.userData = userData;
+        command.layer = layer;
+        commands.push_back(command);
+
+        return &vertices[vertexOffset];
+    }
+
+    // Indices are relative to the first of the given vertices
+    void CommandBuffer::addVertices(const Vertex *vertices, size_t numVertices, const uint32_t *indices, size_t numIndices, uint32_t textureId, const Rectangle &clippingRect, uint32_t shaderId, void *userData) {
+        if(vertices == nullptr || numVertices == 0)
+            return;
+
+        if(indices == nullptr || numIndices == 0) {
+            if(numVertices % 4 != 0)
+                return;
+            Vertex *destination = addQuads(numVertices / 4, textureId, clippingRect, shaderId, userData);
+            std::copy(vertices, vertices + numVertices, destination);
+            return;
+        }
+
+        RecordedCommand command;
+        command.vertexOffset = this->vertices.size();
+        command.numVertices = numVertices;
+        command.indexOffset = this->indices.size();
+        command.numIndices = numIndices;
+        command.instanceOffset = instances.size();
+        command.numInstances = 0;
+        command.textureId = textureId;
+        command.shaderId = shaderId;
+        command.textureIsFont = false;
+        command.clippingRect = clippingRect;
+        command.userData = userData;
+        command.layer = layer;
+        commands.push_back(command);
+
+        this->vertices.insert(this->vertices.end(), vertices, vertices + numVertices);
+        this->indices.insert(this->indices.end(), indices, indices + numIndices);
+    }
+
+    void CommandBuffer::addRectangle(const Vector2 &position, const Vector2 &size, float rotationDegrees, const Color &color, const Rectangle &clippingRect, uint32_t shaderId, void *userData) {
+        Vertex *quad = addQuads(1, 0, clippingRect, shaderId, userData);
+        quad[0] = { Vector2(position.x, position.y), Vector2(0, 1), color }; // top left
+        quad[1] = { Vector2(position.x, position.y + size.y), Vector2(0, 0), color }; // bottom left
+        quad[2] = { Vector2(position.x + size.x, position.y + size.y), Vector2(1, 0), color }; // bottom right
+        quad[3] = { Vector2(position.x + size.x, position.y), Vector2(1, 1), color }; // top right
+
+        if(rotationDegrees != 0.0f)
+            Simd::rotateVertices(quad, 4, rotationDegrees);
+    }
+
+    void CommandBuffer::addRectangles(const Rectangle *rectangles, size_t count, const Color &color, const Rectangle &clippingRect, uint32_t shaderId, void *userData) {
+        if(rectangles == nullptr || count == 0)
+            return;
+        Vertex *quads = addQuads(count, 0, clippingRect, shaderId, userData);
+        Simd::expandRectangles(rectangles, count, color, quads);
+    }
+
+    // Appends an SDF shape, extending the last command when it is a run of shapes with the same state
+    void CommandBuffer::addShape(const InstanceData &instance, const Rectangle &clippingRect, void *userData) {
+        instances.push_back(instance);
+
+        if(commands.size() > 0) {
+            RecordedCommand &last = commands.back();
+            if(last.numInstances > 0 && last.userData == userData && last.layer == layer && sameClippingRect(last.clippingRect, clippingRect)) {
+                last.numInstances++;
+                return;
+            }
+        }
+
+        RecordedCommand command;
+        command.vertexOffset = vertices.size();
+        command.numVertices = 0;
+        command.indexOffset = indices.size();
+        command.numIndices = 0;
+        command.instanceOffset = instances.size() - 1;
+        command.numInstances = 1;
+        command.textureId = 0;
+        command.shaderId = 0;
+        command.textureIsFont = false;
+        command.clippingRect = clippingRect;
+        command.userData = userData;
+        command.layer = layer;
+        commands.push_back(command);
+    }
+
+    void CommandBuffer::addCircle(const Vector2 &position, float radius, int segments, float rotationDegrees, const Color &color, const Rectangle &clippingRect, uint32_t shaderId, void *userData) {
+        // Like Graphics::addCircle the default program gets a single SDF shape, custom shaders the tessellated circle
+        if(shaderId == 0) {
+            if(radius > 0.0f)
+                addShape(InstanceData::createShape(Vector2(position.x - radius, position.y - radius), Vector2(radius * 2.0f, radius * 2.0f), rotationDegrees, color, Vector2(-1, 0)), clippingRect, userData);
+            return;
+        }
+
+        if(segments < 3)
+            segments = 3;
+
+        RecordedCommand command;
+        command.vertexOffset = vertices.size();
+        command.numVertices = segments;
+        command.indexOffset = indices.size();
+        command.numIndices = segments * 3;
+        command.instanceOffset = instances.size();
+        command.numInstances = 0;
+        command.textureId = 0;
+        command.shaderId = shaderId;
+        command.textureIsFont = false;
+        command.clippingRect = clippingRect;
+        command.userData = userData;
+        command.layer = layer;
+        commands.push_back(command);
+
+        vertices.resize(command.vertexOffset + segments);
+        indices.resize(command.indexOffset + command.numIndices);
+
+        Vertex *circle = &vertices[command.vertexOffset];
+        uint32_t *circleIndices = &indices[command.indexOffset];
+
+        for(int i = 0; i < segments; ++i) {
+            float angle = 2.0f * M_PI * i / segments;
+            circle[i].position = Vector2(position.x + radius * cos(angle), position.y + radius * sin(angle));
+            circle[i].uv = Vector2(0.5f + 0.5f * cos(angle), 0.5f + 0.5f * sin(angle));
+        }
+
+        Simd::fillColor(circle, segments, color);
+
+        if(rotationDegrees != 0.0f)
+            Simd::rotateVertices(circle, segments, rotationDegrees);
+
+        for(int i = 0; i < segments; ++i) {
+            circleIndices[i * 3] = 0;
+            circleIndices[i * 3 + 1] = i;
+            circleIndices[i * 3 + 2] = (i + 1) % segments;
+        }
+    }
+
+    void CommandBuffer::addLine(const Vector2 &p1, const Vector2 &p2, float thickness, const Color &color, const Rectangle &clippingRect, uint32_t shaderId, void *userData) {
+        const Vector2 segment[2] = { p1, p2 };
+        addLines(segment, 1, thickness, color, clippingRect, shaderId, userData);
+    }
+
+    void CommandBuffer::addLines(const Vector2 *segments, size_t count, float thickness, const Color &color, const Rectangle &clippingRect, uint32_t shaderId, void *userData) {
+        if(segments == nullptr || count == 0)
+            return;
+
+        // Segments without length turn into empty quads
+        Vertex *quads = addQuads(count, 0, clippingRect, shaderId, userData);
+        Simd::extrudeSegments(segments, count, thickness, color, quads);
+    }
+
+    void CommandBuffer::addTriangle(const Vector2 &position, const Vector2 &size, float rotationDegrees, const Color &color, const Rectangle &clippingRect, uint32_t shaderId, void *userData) {
+        const float radius = size.x / sqrt(3);
+
+        Vertex triangle[3] = {
+            { Vector2(position.x, position.y + radius), Vector2(0.5f, 1.0f), color }, // top
+            { Vector2(position.x - radius * sin(M_PI / 3), position.y - radius * cos(M_PI / 3)), Vector2(0.0f, 0.0f), color }, // bottom left
+            { Vector2(position.x + radius * sin(M_PI / 3), position.y - radius * cos(M_PI / 3)), Vector2(1.0f, 0.0f), color } // bottom right
+        };
+
+        if(rotationDegrees != 0.0f)
+            Simd::rotateVertices(triangle, 3, rotationDegrees);
+
+        const uint32_t triangleIndices[3] = { 0, 1, 2 };
+
+        addVertices(triangle, 3, triangleIndices, 3, 0, clippingRect, shaderId, userData);
+    }
+
+    void CommandBuffer::addImage(const Vector2 &position, const Vector2 &size, float rotationDegrees, uint32_t textureId, const Color &color, const Vector2 &uv0, const Vector2 &uv1, const Rectangle &clippingRect, uint32_t shaderId, void *userData) {
+        Vertex *quad = addQuads(1, textureId, clippingRect, shaderId, userData);
+        quad[0] = { Vector2(position.x, position.y), Vector2(uv0.x, uv0.y), color }; // top left
+        quad[1] = { Vector2(position.x, position.y + size.y), Vector2(uv0.x, uv1.y), color }; // bottom left
+        quad[2] = { Vector2(position.x + size.x, position.y + size.y), Vector2(uv1.x, uv1.y), color }; // bottom right
+        quad[3] = { Vector2(position.x + size.x, position.y), Vector2(uv1.x, uv0.y), color }; // top right
+
+        if(rotationDegrees != 0.0f)
+            Simd::rotateVertices(quad, 4, rotationDegrees);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#include "drawlist.h"
+#include "backend.h"
+#include "../../glad/glad.h"
+
+namespace vexed {
+    DrawList::DrawList() {
+        VAO = 0;
+        VBO = 0;
+        EBO = 0;
+        instanceVAO = 0;
+        instanceVBO = 0;
+        vertexFormat = VertexFormat_Default;
+        revision = 0;
+        valid = false;
+    }
+
+    // The buffers are kept, so recording the list again does not have to create them
+    void DrawList::invalidate() {
+        items.clear();
+        batches.clear();
+        bounds = Rectangle(0, 0, 0, 0);
+        revision++;
+        valid = false;
+    }
+
+    void DrawList::destroy() {
+        invalidate();
+
+        uint32_t vertexArrays[2] = { VAO, instanceVAO };
+        glDeleteVertexArrays(2, vertexArrays);
+
+        Backend *backend = Backend::getInstance();
+        backend->destroyBuffer(VBO);
+        backend->destroyBuffer(EBO);
+        backend->destroyBuffer(instanceVBO);
+
+        VAO = 0;
+        VBO = 0;
+        EBO = 0;
+        instanceVAO = 0;
+        instanceVBO = 0;
+    }
+}
\ No newline at end of file
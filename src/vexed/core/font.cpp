@@ -1,4 +1,5 @@
 #include "font.h"
+#include "backend.h"
 #include "../../glad/glad.h"
 #include <iostream>
 #include <fstream>
@@ -48,7 +49,7 @@ namespace vexed {
 
     void Font::destroy() {
         if(texture > 0) {
-            glDeleteTextures(1, &texture);
+            Backend::getInstance()->destroyTexture(texture);
             texture = 0;
         }
     }
@@ -349,18 +350,20 @@ namespace vexed {
 
         // lineHeight = (ascent - descent + lineGap) * scale;
 
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-
         // The given texture data is a single channel 1 byte per pixel data 
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, fontAtlasWidth, fontAtlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, fontAtlasTextureData.data());
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-        glBindTexture(GL_TEXTURE_2D, 0);
+        TextureDescription description;
+        description.width = fontAtlasWidth;
+        description.height = fontAtlasHeight;
+        description.channels = 1;
+        description.format = TextureFormat_R8;
+        description.wrapS = GL_CLAMP_TO_EDGE;
+        description.wrapT = GL_CLAMP_TO_EDGE;
+        description.minFilter = GL_LINEAR;
+        description.magFilter = GL_LINEAR;
+        description.mipmaps = false;
+        description.data = fontAtlasTextureData.data();
+
+        texture = Backend::getInstance()->createTexture(description);
 
         return true;
     }
@@ -0,0 +1,163 @@
+#include "frametimestats.h"
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+namespace vexed {
+    FrameTimeStats::FrameTimeStats() {
+        windowSize = 0;
+        budget = 0.0;
+        setWindowSize(600);
+    }
+
+    void FrameTimeStats::addFrame(double frame, double update, double render, double swap) {
+        const double durations[FrameTimeKind_COUNT] = { frame, update, render, swap };
+
+        for(size_t k = 0; k < FrameTimeKind_COUNT; k++) {
+            float &sample = samples[k][head];
+
+            // The oldest frame leaves the window
+            if(count == windowSize) {
+                histograms[k][getBucket(sample)]--;
+                if(k == FrameTimeKind_Frame && budget > 0.0 && sample > budget)
+                    framesOverBudget--;
+            }
+
+            sample = static_cast<float>(std::max(durations[k], 0.0));
+            histograms[k][getBucket(sample)]++;
+        }
+
+        // Decided on the stored sample, the same value that is compared when it leaves the window or the budget changes
+        if(budget > 0.0 && samples[FrameTimeKind_Frame][head] > budget) {
+            framesOverBudget++;
+            totalFramesOverBudget++;
+        }
+
+        head = (head + 1) % windowSize;
+        count = std::min(count + 1, windowSize);
+        totalFrames++;
+    }
+
+    void FrameTimeStats::reset() {
+        for(size_t k = 0; k < FrameTimeKind_COUNT; k++) {
+            samples[k].assign(windowSize, 0.0f);
+            histograms[k].assign(HISTOGRAM_BUCKETS, 0);
+        }
+
+        head = 0;
+        count = 0;
+        totalFrames = 0;
+        framesOverBudget = 0;
+        totalFramesOverBudget = 0;
+    }
+
+    void FrameTimeStats::setWindowSize(size_t frames) {
+        windowSize = std::max<size_t>(frames, 1);
+        reset();
+    }
+
+    void FrameTimeStats::setBudget(double milliseconds) {
+        budget = std::max(milliseconds, 0.0);
+        framesOverBudget = 0;
+
+        for(size_t i = 0; i < count && budget > 0.0; i++) {
+            if(samples[FrameTimeKind_Frame][i] > budget)
+                framesOverBudget++;
+        }
+    }
+
+    FrameTimeSummary FrameTimeStats::getSummary(FrameTimeKind kind) const {
+        FrameTimeSummary summary;
+
+        if(count == 0)
+            return summary;
+
+        double sum = 0.0;
+
+        // The ring is only partially filled from index 0 until the window is full, so the first count entries are the frames
+        for(size_t i = 0; i < count; i++) {
+            sum += samples[kind][i];
+            summary.max = std::max(summary.max, static_cast<double>(samples[kind][i]));
+        }
+
+        summary.samples = count;
+        summary.mean = sum / count;
+        summary.p50 = getPercentile(kind, 50.0);
+        summary.p95 = getPercentile(kind, 95.0);
+        summary.p99 = getPercentile(kind, 99.0);
+        return summary;
+    }
+
+    double FrameTimeStats::getPercentile(FrameTimeKind kind, double percentile) const {
+        if(count == 0)
+            return 0.0;
+
+        const std::vector<uint32_t> &histogram = histograms[kind];
+        const double max = *std::max_element(samples[kind].begin(), samples[kind].begin() + count);
+        const double rank = std::max(1.0, std::ceil(std::min(std::max(percentile, 0.0), 100.0) * 0.01 * count));
+        double cumulative = 0.0;
+
+        for(size_t b = 0; b < HISTOGRAM_BUCKETS; b++) {
+            if(histogram[b] == 0 || cumulative + histogram[b] < rank) {
+                cumulative += histogram[b];
+                continue;
+            }
+
+            // Nothing is known about how slow the frames in the last bucket are, other than the maximum
+            if(b == HISTOGRAM_BUCKETS - 1)
+                return max;
+
+            const double fraction = (rank - cumulative) / histogram[b];
+            return std::min((b + fraction) * BUCKET_WIDTH, max);
+        }
+
+        return 0.0;
+    }
+
+    size_t FrameTimeStats::getSamples(FrameTimeKind kind, float *samples, size_t maxCount) const {
+        if(samples == nullptr)
+            return 0;
+
+        const size_t numSamples = std::min(maxCount, count);
+
+        for(size_t i = 0; i < numSamples; i++)
+            samples[i] = this->samples[kind][(head + windowSize - numSamples + i) % windowSize];
+
+        return numSamples;
+    }
+
+    size_t FrameTimeStats::getHistogram(FrameTimeKind kind, uint32_t *counts, size_t maxCount) const {
+        if(counts == nullptr)
+            return 0;
+
+        const size_t numBuckets = std::min(maxCount, HISTOGRAM_BUCKETS);
+        std::copy(histograms[kind].begin(), histograms[kind].begin() + numBuckets, counts);
+        return numBuckets;
+    }
+
+    bool FrameTimeStats::exportCSV(const std::string &filePath) const {
+        std::ofstream file(filePath);
+
+        if(!file.is_open()) {
+            std::cerr << "Failed to open " << filePath << " for writing" << std::endl;
+            return false;
+        }
+
+        file << "frame,frame_ms,update_ms,render_ms,swap_ms\n";
+
+        for(size_t i = 0; i < count; i++) {
+            const size_t index = (head + windowSize - count + i) % windowSize;
+            file << (totalFrames - count + i);
+            for(size_t k = 0; k < FrameTimeKind_COUNT; k++)
+                file << "," << samples[k][index];
+            file << "\n";
+        }
+
+        return file.good();
+    }
+
+    size_t FrameTimeStats::getBucket(float duration) {
+        return std::min(static_cast<size_t>(duration / BUCKET_WIDTH), HISTOGRAM_BUCKETS - 1);
+    }
+}
\ No newline at end of file
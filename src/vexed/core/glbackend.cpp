@@ -0,0 +1,241 @@
+#include "glbackend.h"
+#include "../../glad/glad.h"
+#include <vector>
+#include <cstdio>
+
+namespace vexed {
+    static GLenum getBufferUsage(BufferUsage usage) {
+        switch(usage) {
+            case BufferUsage_Static:
+                return GL_STATIC_DRAW;
+            case BufferUsage_Stream:
+                return GL_STREAM_DRAW;
+            default:
+                return GL_DYNAMIC_DRAW;
+        }
+    }
+
+    static GLenum getPixelFormat(uint32_t channels) {
+        switch(channels) {
+            case 1:
+                return GL_RED;
+            case 2:
+                return GL_RG;
+            case 3:
+                return GL_RGB;
+            default:
+                return GL_RGBA;
+        }
+    }
+
+    uint32_t GLBackend::createBuffer() {
+        GLuint buffer = 0;
+        glGenBuffers(1, &buffer);
+        return buffer;
+    }
+
+    void GLBackend::destroyBuffer(uint32_t buffer) {
+        if(buffer > 0)
+            glDeleteBuffers(1, &buffer);
+    }
+
+    // No vertex array or state cache tracks the copy targets, so binding the buffer there leaves everything else bound as it was
+    void GLBackend::allocateBuffer(uint32_t buffer, size_t size, const void *data, BufferUsage usage) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, size, data, getBufferUsage(usage));
+    }
+
+    bool GLBackend::supportsPersistentMapping() const {
+        return GLAD_GL_VERSION_4_4 != 0;
+    }
+
+    void GLBackend::allocatePersistentBuffer(uint32_t buffer, size_t size) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+    }
+
+    void GLBackend::updateBuffer(uint32_t buffer, size_t offset, size_t size, const void *data) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+    }
+
+    void *GLBackend::mapBuffer(uint32_t buffer, size_t offset, size_t size, MapMode mode) {
+        GLbitfield flags = GL_MAP_WRITE_BIT;
+
+        if(mode == MapMode_Persistent)
+            flags |= GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        else
+            flags |= GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        return glMapBufferRange(GL_COPY_WRITE_BUFFER, offset, size, flags);
+    }
+
+    void GLBackend::unmapBuffer(uint32_t buffer) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    }
+
+    void GLBackend::copyBuffer(uint32_t source, uint32_t destination, size_t sourceOffset, size_t destinationOffset, size_t size) {
+        glBindBuffer(GL_COPY_READ_BUFFER, source);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, destination);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sourceOffset, destinationOffset, size);
+    }
+
+    uint32_t GLBackend::createTexture(const TextureDescription &description) {
+        GLuint texture = 0;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, description.wrapS);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, description.wrapT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, description.minFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, description.magFilter);
+
+        const GLint internalFormat = description.format == TextureFormat_R8 ? GL_R8 : GL_RGBA;
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, description.width, description.height, 0, getPixelFormat(description.channels), GL_UNSIGNED_BYTE, description.data);
+
+        if(description.mipmaps)
+            glGenerateMipmap(GL_TEXTURE_2D);
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return texture;
+    }
+
+    void GLBackend::updateTexture(uint32_t texture, uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint32_t channels, const void *data) {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, getPixelFormat(channels), GL_UNSIGNED_BYTE, data);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    void GLBackend::destroyTexture(uint32_t texture) {
+        if(texture > 0)
+            glDeleteTextures(1, &texture);
+    }
+
+    // The previous framebuffer binding is kept
+    uint32_t GLBackend::createFramebuffer(uint32_t texture) {
+        GLint previous = 0;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
+
+        GLuint framebuffer = 0;
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+
+        const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, previous);
+
+        if(status != GL_FRAMEBUFFER_COMPLETE) {
+            fprintf(stderr, "ERROR: framebuffer is incomplete (0x%X)!\n", status);
+            glDeleteFramebuffers(1, &framebuffer);
+            return 0;
+        }
+
+        return framebuffer;
+    }
+
+    void GLBackend::destroyFramebuffer(uint32_t framebuffer) {
+        if(framebuffer > 0)
+            glDeleteFramebuffers(1, &framebuffer);
+    }
+
+    uint32_t GLBackend::createProgram(const std::string &vertexSource, const std::string &fragmentSource) {
+        const GLchar* vertex_shader[1] = {
+            vertexSource.c_str()
+        };
+
+        const GLchar* fragment_shader[1] = {
+            fragmentSource.c_str()
+        };
+
+        GLuint vert_handle = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vert_handle, 1, vertex_shader, nullptr);
+        glCompileShader(vert_handle);
+        bool check1 = checkShader(vert_handle, "vertex shader");
+
+        GLuint frag_handle = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(frag_handle, 1, fragment_shader, nullptr);
+        glCompileShader(frag_handle);
+        bool check2 = checkShader(frag_handle, "fragment shader");
+
+        GLuint program = glCreateProgram();
+        glAttachShader(program, vert_handle);
+        glAttachShader(program, frag_handle);
+        glLinkProgram(program);
+        bool check3 = checkProgram(program, "shader program");
+
+        glDetachShader(program, vert_handle);
+        glDetachShader(program, frag_handle);
+        glDeleteShader(vert_handle);
+        glDeleteShader(frag_handle);
+
+        if(!check1 || !check2 || !check3) {
+            glDeleteProgram(program);
+            return 0;
+        }
+
+        return program;
+    }
+
+    void GLBackend::destroyProgram(uint32_t program) {
+        if(program > 0) {
+            glDeleteProgram(program);
+            destroyedPrograms++;
+        }
+    }
+
+    void GLBackend::submit(const DrawSubmission &submission) {
+        const GLenum indexType = submission.indexSize == 4 ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+
+        switch(submission.kind) {
+            case SubmissionKind_Elements:
+                if(submission.drawCount == 1)
+                    glDrawElementsBaseVertex(GL_TRIANGLES, submission.counts[0], indexType, const_cast<void*>(submission.offsets[0]), submission.baseVertices[0]);
+                else if(submission.drawCount > 1)
+                    glMultiDrawElementsBaseVertex(GL_TRIANGLES, submission.counts, indexType, submission.offsets, submission.drawCount, submission.baseVertices);
+                break;
+            case SubmissionKind_ElementsInstanced:
+                glDrawElementsInstanced(GL_TRIANGLES, submission.counts[0], indexType, submission.offsets ? submission.offsets[0] : nullptr, submission.instanceCount);
+                break;
+            case SubmissionKind_Arrays:
+                glDrawArrays(GL_TRIANGLES, 0, submission.counts[0]);
+                break;
+        }
+    }
+
+    bool GLBackend::checkShader(uint32_t handle, const char *description) {
+        GLint status = 0, log_length = 0;
+        glGetShaderiv(handle, GL_COMPILE_STATUS, &status);
+        glGetShaderiv(handle, GL_INFO_LOG_LENGTH, &log_length);
+        if (status == GL_FALSE)
+            fprintf(stderr, "ERROR: failed to compile %s!\n", description);
+        if (log_length > 1) {
+            std::vector<char> buf;
+            buf.resize((int)(log_length + 1));
+            glGetShaderInfoLog(handle, log_length, nullptr, &buf[0]);
+            fprintf(stderr, "%s\n", buf.data());
+        }
+
+        return status == GL_TRUE;
+    }
+
+    bool GLBackend::checkProgram(uint32_t handle, const char *description) {
+        GLint status = 0, log_length = 0;
+        glGetProgramiv(handle, GL_LINK_STATUS, &status);
+        glGetProgramiv(handle, GL_INFO_LOG_LENGTH, &log_length);
+        if (status == GL_FALSE)
+            fprintf(stderr, "ERROR: failed to link %s!\n", description);
+        if (log_length > 1) {
+            std::vector<char> buf;
+            buf.resize((int)(log_length + 1));
+            glGetProgramInfoLog(handle, log_length, nullptr, &buf[0]);
+            fprintf(stderr, "%s\n", buf.data());
+        }
+        return status == GL_TRUE;
+    }
+}
\ No newline at end of file
@@ -1,10 +1,20 @@
 #include "graphics.h"
+#include "shader.h"
+#include "atlas.h"
+#include "drawlist.h"
+#include "commandbuffer.h"
+#include "simd.h"
+#include "plotbuffer.h"
+#include "rendertarget.h"
+#include "backend.h"
 #include "../../glad/glad.h"
 #include <cstring>
 #include <cmath>
 #include <cfloat>
 #include <iostream>
 #include <regex>
+#include <algorithm>
+#include <numeric>
 
 namespace vexed {
     Graphics::Graphics() {
@@ -15,55 +25,479 @@ namespace vexed {
         textureId = 0;
         itemCount = 0;
         vertexCount = 0;
-        indiceCount = 0;
+        indexByteCount = 0;
+        vertexData = nullptr;
+        indexData = nullptr;
+        vertexCapacity = 0;
+        indexCapacity = 0;
+        uploadMode = BufferUploadMode_SubData;
+        vertexFormat = VertexFormat_Default;
+        requestedVertexFormat = VertexFormat_Default;
+        requestedUploadMode = BufferUploadMode_SubData;
+        vertexStride = sizeof(Vertex);
+        persistentMapping = false;
+        ringRegion = 0;
+        mappedVertices = nullptr;
+        mappedIndices = nullptr;
+        mappedVertexStart = 0;
+        mappedIndexStart = 0;
+        for(size_t i = 0; i < RING_BUFFER_REGIONS; i++)
+            ringFences[i] = nullptr;
+        instanceVAO = 0;
+        instanceVBO = 0;
+        quadVBO = 0;
+        quadEBO = 0;
+        quadPatternBuffer = 0;
+        instanceShaderId = 0;
+        plotShaderId = 0;
+        plotCount = 0;
+        instanceCount = 0;
+        instancingEnabled = false;
+        contextOwned = false;
+        stateSaved = false;
+        layer = 0;
+        layersUsed = false;
+        sortingEnabled = false;
+        numIssuedStateChanges = 0;
+        numSkippedStateChanges = 0;
+        frameUBO = 0;
+        projectionRevision = 1;
+        destroyedPrograms = 0;
+        recordingList = nullptr;
+        recordItemOffset = 0;
+        recordVertexOffset = 0;
+        recordIndexOffset = 0;
+        recordInstanceOffset = 0;
+        replayCount = 0;
+        recordingTarget = nullptr;
+        targetCount = 0;
+        renderingTarget = false;
+        damageTracking = DamageTracking_None;
+        previousFrameHash = 0;
+        fullDamage = true;
+        frameTarget = nullptr;
+        frameTargetStale = true;
+        partialRedraw = false;
         viewport = { 0, 0, 512, 512 };
         elapsedTime = 0.0f;
+        numDrawCalls = 0;
+        numMergedItems = 0;
+        numUploadedBytes = 0;
+        numBufferReallocations = 0;
+        statsHistory.resize(120);
+        frameNumber = 0;
+        statsHistoryStart = 0;
+        frameEndTime = std::chrono::steady_clock::now();
+        for(size_t i = 0; i < TIMER_QUERY_COUNT; i++) {
+            timerQueries[i] = 0;
+            timerQueryFrames[i] = 0;
+            timerQueryPending[i] = false;
+        }
+        activeTimerQuery = TIMER_QUERY_COUNT;
+        backend = Backend::getInstance();
     }
 
     void Graphics::initialize() {        
+        backend = Backend::getInstance();
+        glGenQueries(TIMER_QUERY_COUNT, timerQueries);
         createBuffers();
+        createFrameUniformBuffer();
         createShader();
         createTexture();
+        createInstanceBuffers();
+        createInstanceShader();
+        createPlotShader();
     }
 
     void Graphics::deinitialize() {
+        releaseBuffers();
+
         if(VAO > 0) {
             glDeleteVertexArrays(1, &VAO);
             VAO = 0;
         }
 
-        if(VBO > 0) {
-            glDeleteBuffers(1, &VBO);
-            VBO = 0;
+        if(shaderId > 0) {
+            backend->destroyProgram(shaderId);
+            shaderId = 0;
         }
 
-        if(EBO > 0) {
-            glDeleteBuffers(1, &EBO);
-            EBO = 0;
+        if(frameUBO > 0) {
+            backend->destroyBuffer(frameUBO);
+            frameUBO = 0;
         }
 
-        if(shaderId > 0) {
-            glDeleteShader(shaderId);
-            shaderId = 0;
+        if(instanceVAO > 0) {
+            glDeleteVertexArrays(1, &instanceVAO);
+            instanceVAO = 0;
+        }
+
+        backend->destroyBuffer(instanceVBO);
+        backend->destroyBuffer(quadVBO);
+        backend->destroyBuffer(quadEBO);
+        backend->destroyBuffer(quadPatternBuffer);
+        instanceVBO = 0;
+        quadVBO = 0;
+        quadEBO = 0;
+        quadPatternBuffer = 0;
+
+        if(instanceShaderId > 0) {
+            backend->destroyProgram(instanceShaderId);
+            instanceShaderId = 0;
+        }
+
+        if(plotShaderId > 0) {
+            backend->destroyProgram(plotShaderId);
+            plotShaderId = 0;
         }
 
         if(textureId > 0) {
-            glDeleteTextures(1, &textureId);
+            backend->destroyTexture(textureId);
             textureId = 0;
         }
+
+        if(timerQueries[0] > 0) {
+            glDeleteQueries(TIMER_QUERY_COUNT, timerQueries);
+            for(size_t i = 0; i < TIMER_QUERY_COUNT; i++) {
+                timerQueries[i] = 0;
+                timerQueryPending[i] = false;
+            }
+        }
+
+        if(frameTarget) {
+            frameTarget->destroy();
+            delete frameTarget;
+            frameTarget = nullptr;
+        }
+
+        stateCache.invalidate();
     }
 
-    void Graphics::newFrame(float deltaTime) {
+    bool Graphics::newFrame(float deltaTime) {
+        const auto submitStart = std::chrono::steady_clock::now();
+
+        beginFrameStats();
+
+        if(recordingTarget) {
+            std::cerr << "Graphics::newFrame called while recording a render target, call endRenderTarget first" << std::endl;
+            endRenderTarget();
+        } else if(recordingList) {
+            std::cerr << "Graphics::newFrame called while recording a draw list, call endDrawList first" << std::endl;
+            endDrawList();
+        }
+
+        if(!clipStack.empty()) {
+            std::cerr << "Graphics::newFrame called with " << clipStack.size() << " clipping rectangles left on the stack" << std::endl;
+            clipStack.clear();
+        }
+
+        // Items are compared in the order they are drawn in
+        if(sortingEnabled || layersUsed)
+            sortItems();
+
+        const bool partial = damageTracking == DamageTracking_Partial && prepareFrameTarget();
+        Rectangle damage(0, 0, viewport.width, viewport.height);
+
+        if(damageTracking != DamageTracking_None && !findDamage(damage, partial)) {
+            resetItems();
+            numDrawCalls = 0;
+            numMergedItems = 0;
+            numIssuedStateChanges = 0;
+            numSkippedStateChanges = 0;
+            elapsedTime += deltaTime;
+            frameStats.skipped = true;
+            frameStats.damage = Rectangle(0, 0, 0, 0);
+            endFrameStats(submitStart);
+            return false;
+        }
+
+        frameStats.damage = damage;
+
         glClear(GL_COLOR_BUFFER_BIT);
         glClearColor(clearColor.r, clearColor.g, clearColor.b, clearColor.a);
 
-        numDrawCalls = itemCount;
-
-        if(itemCount == 0) {
+        if(itemCount == 0 && targetCount == 0) {
+            // Only the screen was cleared, the frame target still holds the previous frame
+            frameTargetStale = true;
+            replayCount = 0;
+            plotCount = 0;
+            numDrawCalls = 0;
+            numMergedItems = 0;
+            numIssuedStateChanges = 0;
+            numSkippedStateChanges = 0;
             elapsedTime += deltaTime;
-            return;
+            endFrameStats(submitStart);
+            return true;
+        }
+
+        if(partial)
+            cullItems(damage);
+
+        size_t batchCount = batchItems(items.data(), itemCount, batches);
+
+        numDrawCalls = 0;
+        numMergedItems = itemCount - batchCount;
+
+        // The frame target is shown by a quad of its own, batched apart from the items it is drawn after
+        if(partial) {
+            addRenderTarget(frameTarget, Vector2(0, 0), Vector2(viewport.width, viewport.height));
+            batches.push_back({ itemCount - 1, 1 });
+        }
+
+        if(contextOwned) {
+            // Nobody else touches the state, except for textures which get bound while loading
+            stateCache.invalidateTexture();
+        } else {
+            stateCache.invalidate();
+            // The queries can stall the pipeline, so they are only repeated when the application says its state changed
+            if(!stateSaved) {
+                storeState();
+                stateSaved = true;
+            }
+        }
+
+        stateCache.setDepthTest(false);
+        stateCache.setBlend(true);
+        stateCache.setBlendEquation(GL_FUNC_ADD);
+        stateCache.setActiveTexture(GL_TEXTURE0);
+
+        // Program names are reused once deleted, so locations cached for a name may belong to a different program by now
+        if(backend->getDestroyedPrograms() != destroyedPrograms) {
+            destroyedPrograms = backend->getDestroyedPrograms();
+            modelUniforms.clear();
+            legacyFrameUniforms.clear();
+        }
+
+        // Replay indices are only valid for this frame, so every program has to get its model matrix again
+        for(auto &modelUniform : modelUniforms)
+            modelUniform.second.replay = MODEL_UNIFORM_UNKNOWN;
+
+        // Targets are composited by the items of this frame, so their content has to be there first
+        if(targetCount > 0)
+            drawRenderTargets();
+
+        GLint screenFramebuffer = 0;
+
+        if(partial) {
+            glGetIntegerv(GL_FRAMEBUFFER_BINDING, &screenFramebuffer);
+            glBindFramebuffer(GL_FRAMEBUFFER, frameTarget->framebuffer);
+
+            damageScissor = Rectangle(damage.x, viewport.height - damage.y - damage.height, damage.width, damage.height);
+            partialRedraw = true;
+            renderingTarget = true;
+
+            // The clear is limited to the damaged area by the scissor, and premultiplied like everything else in the target
+            setScissor(Rectangle(0, 0, 0, 0));
+            glClearColor(clearColor.r * clearColor.a, clearColor.g * clearColor.a, clearColor.b * clearColor.a, clearColor.a);
+            glClear(GL_COLOR_BUFFER_BIT);
+            glClearColor(clearColor.r, clearColor.g, clearColor.b, clearColor.a);
+        }
+
+        updateFrameUniforms();
+
+        size_t baseVertex = 0;
+        size_t indexOffset = QUAD_PATTERN_SIZE;
+
+        if(uploadMode == BufferUploadMode_RingBuffer) {
+            // Geometry was written directly into the mapped region, it only has to be made available to the GPU
+            unmapRingRegion();
+            baseVertex = ringRegion * vertexCapacity;
+            indexOffset += ringRegion * indexCapacity;
+        }
+
+        stateCache.bindVertexArray(VAO);
+        stateCache.bindBuffer(GL_ARRAY_BUFFER, VBO);
+        stateCache.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+        numUploadedBytes += vertexCount * vertexStride + indexByteCount;
+
+        if(uploadMode == BufferUploadMode_SubData) {
+            backend->updateBuffer(VBO, 0, vertexCount * vertexStride, vertices.data());
+            if(indexByteCount > 0)
+                backend->updateBuffer(EBO, QUAD_PATTERN_SIZE, indexByteCount, indices.data());
+        }
+
+        if(instanceCount > 0) {
+            // Orphan the previous storage so the upload does not have to wait for the GPU
+            backend->allocateBuffer(instanceVBO, instanceCount * sizeof(InstanceData), instances.data(), BufferUsage_Stream);
+            numUploadedBytes += instanceCount * sizeof(InstanceData);
+        }
+
+        for(size_t b = 0; b < batchCount; b++) {
+            const DrawListItem &item = items[batches[b].itemOffset];
+
+            if(item.replay != DrawListItem::NO_REPLAY) {
+                replayDrawList(item);
+                continue;
+            }
+
+            if(item.plot != DrawListItem::NO_PLOT) {
+                drawPlotBuffer(item);
+                continue;
+            }
+
+            applyItemState(item, item.clippingRect, DrawListItem::NO_REPLAY);
+
+            stateCache.bindVertexArray(item.instanceCount > 0 ? instanceVAO : VAO);
+
+            drawBatch(items.data(), batches[b], baseVertex, indexOffset, instanceVBO);
+        }
+
+        if(partial) {
+            partialRedraw = false;
+            renderingTarget = false;
+            frameTargetStale = false;
+
+            glBindFramebuffer(GL_FRAMEBUFFER, screenFramebuffer);
+
+            const DrawBatch &batch = batches[batchCount];
+            applyItemState(items[batch.itemOffset], items[batch.itemOffset].clippingRect, DrawListItem::NO_REPLAY);
+            stateCache.bindVertexArray(VAO);
+            drawBatch(items.data(), batch, baseVertex, indexOffset, instanceVBO);
+        }
+
+        if(uploadMode == BufferUploadMode_RingBuffer)
+            advanceRingRegion();
+
+        // The scissor test would otherwise also apply to the clear of the next frame
+        stateCache.setScissorTest(false);
+
+        if(!contextOwned) {
+            stateCache.bindVertexArray(0);
+            stateCache.bindBuffer(GL_ARRAY_BUFFER, 0);
+            restoreState();
+        }
+
+        numIssuedStateChanges = stateCache.getIssuedChanges();
+        numSkippedStateChanges = stateCache.getSkippedChanges();
+
+        resetItems();
+
+        elapsedTime += deltaTime;
+
+        endFrameStats(submitStart);
+        return true;
+    }
+
+    // Reset counts for the next render
+    void Graphics::resetItems() {
+        itemCount = 0;
+        vertexCount = 0;
+        indexByteCount = 0;
+        instanceCount = 0;
+        replayCount = 0;
+        plotCount = 0;
+        targetCount = 0;
+        layersUsed = false;
+
+        if(requestedVertexFormat != vertexFormat)
+            setVertexFormat(requestedVertexFormat);
+
+        if(requestedUploadMode != uploadMode)
+            setBufferUploadMode(requestedUploadMode);
+    }
+
+    // Takes the counts of what was added for the frame and starts timing it on the GPU, when a query is free
+    void Graphics::beginFrameStats() {
+        readTimerQueries();
+
+        frameStats = FrameStats();
+        frameStats.frame = frameNumber;
+        frameStats.items = itemCount;
+        frameStats.instances = instanceCount;
+        frameStats.vertices = vertexCount;
+
+        for(size_t i = 0; i < itemCount; i++)
+            frameStats.indices += items[i].indiceCount;
+
+        activeTimerQuery = TIMER_QUERY_COUNT;
+
+        for(size_t i = 0; i < TIMER_QUERY_COUNT; i++) {
+            if(timerQueries[i] > 0 && !timerQueryPending[i]) {
+                glBeginQuery(GL_TIME_ELAPSED, timerQueries[i]);
+                activeTimerQuery = i;
+                break;
+            }
+        }
+    }
+
+    void Graphics::endFrameStats(const std::chrono::steady_clock::time_point &submitStart) {
+        if(activeTimerQuery < TIMER_QUERY_COUNT) {
+            glEndQuery(GL_TIME_ELAPSED);
+            timerQueryPending[activeTimerQuery] = true;
+            timerQueryFrames[activeTimerQuery] = frameNumber;
+            activeTimerQuery = TIMER_QUERY_COUNT;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+
+        frameStats.drawCalls = numDrawCalls;
+        frameStats.mergedItems = numMergedItems;
+        frameStats.uploadedBytes = numUploadedBytes;
+        frameStats.shaderSwitches = stateCache.getProgramChanges();
+        frameStats.textureSwitches = stateCache.getTextureChanges();
+        frameStats.scissorChanges = stateCache.getScissorChanges();
+        frameStats.bufferReallocations = numBufferReallocations;
+        frameStats.recordTime = std::chrono::duration<double, std::milli>(submitStart - frameEndTime).count();
+        frameStats.submitTime = std::chrono::duration<double, std::milli>(now - submitStart).count();
+
+        statsHistory[frameNumber % statsHistory.size()] = frameStats;
+
+        stateCache.resetCounters();
+        numUploadedBytes = 0;
+        numBufferReallocations = 0;
+        frameNumber++;
+        frameEndTime = now;
+    }
+
+    // Only results that are already available are read, so the CPU never waits for the GPU to catch up
+    void Graphics::readTimerQueries() {
+        for(size_t i = 0; i < TIMER_QUERY_COUNT; i++) {
+            if(!timerQueryPending[i])
+                continue;
+
+            GLint available = 0;
+            glGetQueryObjectiv(timerQueries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+
+            if(!available)
+                continue;
+
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(timerQueries[i], GL_QUERY_RESULT, &elapsed);
+            timerQueryPending[i] = false;
+
+            FrameStats &stats = statsHistory[timerQueryFrames[i] % statsHistory.size()];
+
+            if(stats.frame == timerQueryFrames[i])
+                stats.gpuTime = static_cast<double>(elapsed) / 1000000.0;
         }
+    }
+
+    const FrameStats &Graphics::getFrameStats() const {
+        if(frameNumber == statsHistoryStart)
+            return frameStats;
+        return statsHistory[(frameNumber - 1) % statsHistory.size()];
+    }
+
+    size_t Graphics::getFrameStatsHistory(FrameStats *stats, size_t maxCount) const {
+        if(stats == nullptr)
+            return 0;
+
+        const size_t count = std::min(maxCount, static_cast<size_t>(std::min<uint64_t>(frameNumber - statsHistoryStart, statsHistory.size())));
+
+        for(size_t i = 0; i < count; i++)
+            stats[i] = statsHistory[(frameNumber - count + i) % statsHistory.size()];
+
+        return count;
+    }
 
+    void Graphics::setFrameStatsHistorySize(size_t frames) {
+        statsHistory.assign(std::max<size_t>(frames, 1), FrameStats());
+        statsHistoryStart = frameNumber;
+    }
+
+    // Uploads the constants shared by all programs for this frame and binds them to the fixed binding point
+    void Graphics::updateFrameUniforms() {
         const float L = viewport.x;
         const float R = viewport.x + viewport.width;
         const float T = viewport.y;
@@ -71,94 +505,371 @@ namespace vexed {
         const float near = -1.0f;
         const float far = 1.0f;
 
-        const float projectionMatrix[4][4] = {
-            { 2.0f / (R - L),    0.0f,            0.0f,              0.0f },
-            { 0.0f,              2.0f / (T - B),  0.0f,              0.0f },
-            { 0.0f,              0.0f,           -1.0f / (far - near), 0.0f },
-            { -(R + L) / (R - L), -(T + B) / (T - B), (far + near) / (far - near), 1.0f }
+        const float projectionMatrix[16] = {
+            2.0f / (R - L),    0.0f,            0.0f,              0.0f,
+            0.0f,              2.0f / (T - B),  0.0f,              0.0f,
+            0.0f,              0.0f,           -1.0f / (far - near), 0.0f,
+            -(R + L) / (R - L), -(T + B) / (T - B), (far + near) / (far - near), 1.0f
         };
 
-        storeState();
-        
-        glDisable(GL_DEPTH_TEST);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        glBlendEquation(GL_FUNC_ADD);
+        if(memcmp(frameUniforms.projection, projectionMatrix, sizeof(projectionMatrix)) != 0) {
+            memcpy(frameUniforms.projection, projectionMatrix, sizeof(projectionMatrix));
+            projectionRevision++;
+        }
+
+        frameUniforms.viewport[0] = viewport.x;
+        frameUniforms.viewport[1] = viewport.y;
+        frameUniforms.viewport[2] = viewport.width;
+        frameUniforms.viewport[3] = viewport.height;
+        frameUniforms.time = elapsedTime;
+
+        backend->updateBuffer(frameUBO, 0, sizeof(FrameUniforms), &frameUniforms);
+        numUploadedBytes += sizeof(FrameUniforms);
+        glBindBufferBase(GL_UNIFORM_BUFFER, Shader::FRAME_UNIFORM_BINDING, frameUBO);
+    }
+
+    static bool haveSameState(const DrawListItem &a, const DrawListItem &b) {
+        // A replayed draw list brings its own batches and a plot buffer its own draw call
+        if(a.replay != DrawListItem::NO_REPLAY || b.replay != DrawListItem::NO_REPLAY)
+            return false;
+        if(a.plot != DrawListItem::NO_PLOT || b.plot != DrawListItem::NO_PLOT)
+            return false;
+        if(a.shaderId != b.shaderId || a.textureId != b.textureId || a.textureIsFont != b.textureIsFont)
+            return false;
+        if(a.premultiplied != b.premultiplied)
+            return false;
+        if(a.userData != b.userData)
+            return false;
+        if((a.instanceCount > 0) != (b.instanceCount > 0))
+            return false;
+        if(a.instanceCount == 0 && a.indexSize != b.indexSize)
+            return false;
+        const Rectangle &r1 = a.clippingRect;
+        const Rectangle &r2 = b.clippingRect;
+        return r1.x == r2.x && r1.y == r2.y && r1.width == r2.width && r1.height == r2.height;
+    }
+
+    static bool canMergeItems(const DrawListItem &a, const DrawListItem &b) {
+        if(!haveSameState(a, b))
+            return false;
+        // Instances are read straight from the instance buffer, so they have to be contiguous
+        if(a.instanceCount > 0 && a.instanceOffset + a.instanceCount != b.instanceOffset)
+            return false;
+        return true;
+    }
+
+    static bool overlaps(const Rectangle &a, const Rectangle &b) {
+        return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+    }
+
+    static Rectangle unite(const Rectangle &a, const Rectangle &b) {
+        float x = std::min(a.x, b.x);
+        float y = std::min(a.y, b.y);
+        float right = std::max(a.x + a.width, b.x + b.width);
+        float bottom = std::max(a.y + a.height, b.y + b.height);
+        return Rectangle(x, y, right - x, bottom - y);
+    }
 
-        glBindVertexArray(VAO);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, vertexCount * sizeof(Vertex), vertices.data());
+    // Bits from high to low: layer (16), shader (12), texture (16), clipping rectangle hash (16), flags (4)
+    // Equal keys are only a hint, items still have to pass haveSameState before they are grouped
+    static uint64_t makeSortKey(const DrawListItem &item) {
+        const int32_t layer = std::max(-32768, std::min(32767, item.layer));
+
+        uint32_t clip = 2166136261u;
+        const float rect[4] = { item.clippingRect.x, item.clippingRect.y, item.clippingRect.width, item.clippingRect.height };
+        for(size_t i = 0; i < 4; i++) {
+            uint32_t bits;
+            memcpy(&bits, &rect[i], sizeof(float));
+            clip = (clip ^ bits) * 16777619u;
+        }
+        clip = (clip >> 16) ^ (clip & 0xFFFF);
+
+        uint64_t flags = 0;
+        if(item.instanceCount > 0)
+            flags |= 1;
+        if(item.textureIsFont)
+            flags |= 2;
+        if(item.indexSize == sizeof(uint32_t))
+            flags |= 4;
+        if(item.premultiplied)
+            flags |= 8;
+
+        return (static_cast<uint64_t>(layer + 32768) << 48) |
+               (static_cast<uint64_t>(item.shaderId & 0xFFF) << 36) |
+               (static_cast<uint64_t>(item.textureId & 0xFFFF) << 20) |
+               (static_cast<uint64_t>(clip) << 4) |
+               flags;
+    }
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indiceCount * sizeof(uint32_t), indices.data());
+    // Puts the items in layer order and, when sorting is enabled, moves items back to an earlier item with the same
+    // state as long as they do not overlap anything drawn in between, so the output looks the same with fewer batches
+    void Graphics::sortItems() {
+        sortOrder.resize(itemCount);
+        std::iota(sortOrder.begin(), sortOrder.end(), 0);
 
-        uint32_t lastShaderId = items[0].shaderId;
-        glUseProgram(lastShaderId);
-        glActiveTexture(GL_TEXTURE0);
+        for(size_t i = 0; i < itemCount; i++)
+            items[i].sortKey = makeSortKey(items[i]);
 
-        uint32_t lastTextureId = items[0].textureId;
-        glBindTexture(GL_TEXTURE_2D, lastTextureId);
+        if(layersUsed) {
+            std::stable_sort(sortOrder.begin(), sortOrder.end(), [this] (size_t a, size_t b) {
+                return items[a].layer < items[b].layer;
+            });
+        }
 
-        size_t drawOffset = 0; // Offset for the draw call
+        sortGroups.clear();
+        sortNext.assign(itemCount, SIZE_MAX);
 
         for(size_t i = 0; i < itemCount; i++) {
-            Rectangle rect = items[i].clippingRect;
-            bool scissorEnabled = false;
-            if(!rect.isZero()) {
-                glEnable(GL_SCISSOR_TEST);
-                glScissor(rect.x, rect.y, rect.width, rect.height);
-                scissorEnabled = true;
+            const size_t index = sortOrder[i];
+            const DrawListItem &item = items[index];
+            size_t target = SIZE_MAX;
+
+            if(sortingEnabled) {
+                size_t searched = 0;
+                for(size_t g = sortGroups.size(); g-- > 0 && searched < SORT_LOOKBACK; searched++) {
+                    const SortGroup &group = sortGroups[g];
+                    if(group.layer != item.layer)
+                        break;
+                    if(group.key == item.sortKey && haveSameState(items[group.lastItem], item)) {
+                        target = g;
+                        break;
+                    }
+                    if(overlaps(group.bounds, item.bounds))
+                        break;
+                }
             }
 
-            if(items[i].shaderId != lastShaderId) {
-                glUseProgram(items[i].shaderId);
-                lastShaderId = items[i].shaderId;
+            if(target == SIZE_MAX) {
+                sortGroups.push_back({ item.sortKey, item.layer, index, index, item.bounds });
+            } else {
+                SortGroup &group = sortGroups[target];
+                sortNext[group.lastItem] = index;
+                group.lastItem = index;
+                group.bounds = unite(group.bounds, item.bounds);
             }
+        }
+
+        if(sortedItems.size() < items.size())
+            sortedItems.resize(items.size());
+        if(sortedInstances.size() < instances.size())
+            sortedInstances.resize(instances.size());
+
+        size_t count = 0;
+        size_t instanceOffset = 0;
 
-            if(items[i].textureId != lastTextureId) {
-                glBindTexture(GL_TEXTURE_2D, items[i].textureId);
-                lastTextureId = items[i].textureId;
+        for(const SortGroup &group : sortGroups) {
+            for(size_t index = group.firstItem; index != SIZE_MAX; index = sortNext[index]) {
+                DrawListItem &item = sortedItems[count++];
+                item = items[index];
+
+                // Instances are moved along with their item, so the ones of a group end up contiguous again
+                if(item.instanceCount > 0) {
+                    memcpy(&sortedInstances[instanceOffset], &instances[item.instanceOffset], item.instanceCount * sizeof(InstanceData));
+                    item.instanceOffset = instanceOffset;
+                    instanceOffset += item.instanceCount;
+                }
             }
+        }
+
+        items.swap(sortedItems);
+
+        if(instanceCount > 0)
+            instances.swap(sortedInstances);
+    }
+
+    // Groups consecutive items that share the same state into batches, so they can be drawn with one call
+    // Returns the number of resulting batches
+    size_t Graphics::batchItems(const DrawListItem *items, size_t count, std::vector<DrawBatch> &batches) {
+        batches.clear();
+
+        if(count == 0)
+            return 0;
 
-            if(lastShaderId == shaderId) {
-                glUniform1i(uniforms[Uniform_Texture], 0);
-                glUniformMatrix4fv(uniforms[Uniform_Projection], 1, GL_FALSE, &projectionMatrix[0][0]);
-                glUniform1f(uniforms[Uniform_Time], elapsedTime);
-                //This uniform is only mandatory on default shader
-                glUniform1i(uniforms[Uniform_IsFont], items[i].textureIsFont ? 1 : 0);
+        batches.push_back({ 0, 1 });
+
+        for(size_t i = 1; i < count; i++) {
+            DrawBatch &batch = batches.back();
+
+            if(canMergeItems(items[batch.itemOffset + batch.itemCount - 1], items[i])) {
+                batch.itemCount++;
             } else {
-                // Only dispatch callback for custom shaders
-                //These 3 uniforms are mandatory on any shader
-                glUniform1i(glGetUniformLocation(lastShaderId, "uTexture"), 0);
-                glUniformMatrix4fv(glGetUniformLocation(lastShaderId, "uProjection"), 1, GL_FALSE, &projectionMatrix[0][0]);
-                glUniform1f(glGetUniformLocation(lastShaderId, "uTime"), elapsedTime);
-                if(uniformUpdate)
-                    uniformUpdate(lastShaderId, items[i].userData);
+                batches.push_back({ i, 1 });
             }
+        }
+
+        return batches.size();
+    }
 
-            glDrawElements(GL_TRIANGLES, items[i].indiceCount, GL_UNSIGNED_INT, (void*)(drawOffset * sizeof(uint32_t)));
+    // Sets the scissor, program, texture and uniforms for the batch starting at the given item
+    // The clipping rectangle is passed separately because replayed draw lists move their own rectangles
+    void Graphics::applyItemState(const DrawListItem &item, const Rectangle &clippingRect, size_t replay) {
+        setScissor(clippingRect);
 
-            drawOffset += items[i].indiceCount;
+        setBlendFunc(item.premultiplied);
 
-            if(scissorEnabled) {
-                glDisable(GL_SCISSOR_TEST);
-            }
+        stateCache.useProgram(item.shaderId);
+        stateCache.bindTexture(item.textureId);
+
+        // Projection, viewport and time come from the frame uniform block, samplers default to texture unit 0
+        if(item.shaderId == shaderId) {
+            //This uniform is only mandatory on default shader
+            glUniform1i(uniforms[Uniform_IsFont], item.textureIsFont ? 1 : 0);
+        } else if(item.shaderId != instanceShaderId) {
+            setLegacyFrameUniforms(item.shaderId);
+
+            // Only dispatch callback for custom shaders
+            if(uniformUpdate)
+                uniformUpdate(item.shaderId, item.userData);
         }
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
-        
-        restoreState();
+        setModelUniform(item.shaderId, replay);
+    }
 
-        glDisable(GL_SCISSOR_TEST);
+    // Render targets keep premultiplied colors, the alpha channel accumulates coverage so the target can be composited
+    // on top of anything with the premultiplied blend function
+    void Graphics::setBlendFunc(bool premultiplied) {
+        if(premultiplied)
+            stateCache.setBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        else if(renderingTarget)
+            stateCache.setBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        else
+            stateCache.setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
 
-        // Reset counts for the next render
-        itemCount = 0;
-        vertexCount = 0;
-        indiceCount = 0;
+    // Uploads the transform of a replayed draw list, or the identity for regular geometry, to the uModel uniform
+    // Custom shaders may leave the uniform out, in which case draw lists are replayed without their transform
+    // Expects the program to be in use
+    void Graphics::setModelUniform(uint32_t programId, size_t replay) {
+        auto it = modelUniforms.find(programId);
 
-        elapsedTime += deltaTime;
+        if(it == modelUniforms.end()) {
+            ModelUniform modelUniform = { glGetUniformLocation(programId, "uModel"), MODEL_UNIFORM_UNKNOWN };
+            it = modelUniforms.emplace(programId, modelUniform).first;
+        }
+
+        ModelUniform &modelUniform = it->second;
+
+        if(modelUniform.location < 0 || modelUniform.replay == replay)
+            return;
+
+        static const float identity[16] = {
+            1.0f, 0.0f, 0.0f, 0.0f,
+            0.0f, 1.0f, 0.0f, 0.0f,
+            0.0f, 0.0f, 1.0f, 0.0f,
+            0.0f, 0.0f, 0.0f, 1.0f
+        };
+
+        const float *model = replay == DrawListItem::NO_REPLAY ? identity : replays[replay].model;
+        glUniformMatrix4fv(modelUniform.location, 1, GL_FALSE, model);
+        modelUniform.replay = replay;
+    }
+
+    // Custom shaders written before the frame uniform block declare uProjection and uTime as plain uniforms, which would
+    // otherwise never be set. Each is uploaded again only when its value changed since the program last got it, uniforms
+    // start out as zero after linking
+    // Expects the program to be in use
+    void Graphics::setLegacyFrameUniforms(uint32_t programId) {
+        auto it = legacyFrameUniforms.find(programId);
+
+        if(it == legacyFrameUniforms.end()) {
+            LegacyFrameUniforms legacy = { glGetUniformLocation(programId, "uProjection"), glGetUniformLocation(programId, "uTime"), 0, 0.0f };
+            it = legacyFrameUniforms.emplace(programId, legacy).first;
+        }
+
+        LegacyFrameUniforms &legacy = it->second;
+
+        if(legacy.projectionLocation >= 0 && legacy.projectionRevision != projectionRevision) {
+            glUniformMatrix4fv(legacy.projectionLocation, 1, GL_FALSE, frameUniforms.projection);
+            legacy.projectionRevision = projectionRevision;
+        }
+
+        if(legacy.timeLocation >= 0 && legacy.time != frameUniforms.time) {
+            glUniform1f(legacy.timeLocation, frameUniforms.time);
+            legacy.time = frameUniforms.time;
+        }
+    }
+
+    // Issues the draw call for a batch, expects the state of its first item and the matching VAO to be bound
+    // Quads are drawn from the static pattern and other geometry from its own indices, each with its own base vertex
+    // so the whole batch fits in a single glMultiDrawElementsBaseVertex call
+    void Graphics::drawBatch(const DrawListItem *items, const DrawBatch &batch, size_t baseVertex, size_t indexOffset, uint32_t instanceBuffer) {
+        const DrawListItem &first = items[batch.itemOffset];
+
+        if(first.instanceCount > 0) {
+            size_t count = 0;
+            for(size_t i = 0; i < batch.itemCount; i++)
+                count += items[batch.itemOffset + i].instanceCount;
+            setInstanceAttributes(instanceBuffer, first.instanceOffset);
+
+            const int32_t indexCount = 6;
+
+            DrawSubmission submission;
+            submission.kind = SubmissionKind_ElementsInstanced;
+            submission.indexSize = sizeof(uint32_t);
+            submission.counts = &indexCount;
+            submission.offsets = nullptr;
+            submission.baseVertices = nullptr;
+            submission.drawCount = 1;
+            submission.instanceCount = count;
+
+            backend->submit(submission);
+            numDrawCalls++;
+            return;
+        }
+
+        drawCounts.clear();
+        drawOffsets.clear();
+        drawBaseVertices.clear();
+
+        size_t runStart = 0;
+        size_t runQuads = 0;
+
+        auto flushQuadRun = [&] () {
+            for(size_t done = 0; done < runQuads; done += MAX_QUADS_PER_DRAW) {
+                size_t quads = std::min(MAX_QUADS_PER_DRAW, runQuads - done);
+                drawCounts.push_back(quads * 6);
+                drawOffsets.push_back(nullptr);
+                drawBaseVertices.push_back(baseVertex + runStart + (done * 4));
+            }
+            runQuads = 0;
+        };
+
+        for(size_t i = 0; i < batch.itemCount; i++) {
+            const DrawListItem &item = items[batch.itemOffset + i];
+
+            if(item.quads) {
+                // Quads that are adjacent in the vertex buffer share one range of the pattern
+                if(runQuads > 0 && runStart + (runQuads * 4) == item.vertexOffset) {
+                    runQuads += item.vertexCount / 4;
+                } else {
+                    flushQuadRun();
+                    runStart = item.vertexOffset;
+                    runQuads = item.vertexCount / 4;
+                }
+            } else {
+                flushQuadRun();
+                drawCounts.push_back(item.indiceCount);
+                drawOffsets.push_back((void*)(indexOffset + item.indiceOffset));
+                drawBaseVertices.push_back(baseVertex + item.vertexOffset);
+            }
+        }
+
+        flushQuadRun();
+
+        if(drawCounts.size() == 0)
+            return;
+
+        DrawSubmission submission;
+        submission.kind = SubmissionKind_Elements;
+        submission.indexSize = first.indexSize;
+        submission.counts = drawCounts.data();
+        submission.offsets = drawOffsets.data();
+        submission.baseVertices = drawBaseVertices.data();
+        submission.drawCount = drawCounts.size();
+        submission.instanceCount = 0;
+
+        backend->submit(submission);
+        numDrawCalls++;
     }
 
     void Graphics::storeState() {
@@ -166,27 +877,38 @@ namespace vexed {
         glState.blendEnabled = glIsEnabled(GL_BLEND);
         glGetIntegerv(GL_BLEND_SRC, &glState.blendSrcFactor);
         glGetIntegerv(GL_BLEND_DST, &glState.blendDstFactor);
+        glGetIntegerv(GL_BLEND_SRC_ALPHA, &glState.blendSrcAlphaFactor);
+        glGetIntegerv(GL_BLEND_DST_ALPHA, &glState.blendDstAlphaFactor);
         glGetIntegerv(GL_BLEND_EQUATION, &glState.blendEquation);
         glGetIntegerv(GL_DEPTH_FUNC, &glState.depthFunc);
     }
 
     void Graphics::restoreState() {
-        if (glState.depthTestEnabled)
-            glEnable(GL_DEPTH_TEST);
-        else
-            glDisable(GL_DEPTH_TEST);
-
-        if (glState.blendEnabled)
-            glEnable(GL_BLEND);
-        else
-            glDisable(GL_BLEND);
-
-        glBlendFunc(glState.blendSrcFactor, glState.blendDstFactor);
-        glBlendEquation(glState.blendEquation);
-        glDepthFunc(glState.depthFunc);
+        stateCache.setDepthTest(glState.depthTestEnabled);
+        stateCache.setBlend(glState.blendEnabled);
+        stateCache.setBlendFuncSeparate(glState.blendSrcFactor, glState.blendDstFactor, glState.blendSrcAlphaFactor, glState.blendDstAlphaFactor);
+        stateCache.setBlendEquation(glState.blendEquation);
+        stateCache.setDepthFunc(glState.depthFunc);
     }
 
+    static void setInstanceColor(InstanceData &instance, const Color &color);
+    static Rectangle clipBounds(const Rectangle &bounds, const Rectangle &clippingRect);
+    static void writeQuadPattern(uint16_t *pattern, size_t numQuads);
+
     void Graphics::addRectangle(const Vector2 &position, const Vector2 &size, float rotationDegrees, const Color &color, const Rectangle &clippingRect, uint32_t shaderId, void *userData) {
+        if(instancingEnabled && shaderId == 0) {
+            InstanceData instance;
+            instance.position = position;
+            instance.size = size;
+            instance.uv0 = Vector2(0, 1);
+            instance.uv1 = Vector2(1, 0);
+            setInstanceColor(instance, color);
+            instance.rotation = rotationDegrees * (M_PI / 180.0f);
+            instance.kind = InstanceKind_Rectangle;
+            addInstance(instance, textureId, clippingRect, userData);
+            return;
+        }
+
         Vertex vertices[4] = {
             { Vector2(position.x, position.y), Vector2(0, 1), color }, // top left
             { Vector2(position.x, position.y + size.y), Vector2(0, 0), color }, // bottom left
@@ -195,16 +917,11 @@ namespace vexed {
         };
 
         if(rotationDegrees != 0.0f)
-            rotateVertices(vertices, 4, rotationDegrees);
-
-        uint32_t indices[6] = {
-            0, 1, 2, 
-            0, 2, 3
-        };
+            Simd::rotateVertices(vertices, 4, rotationDegrees);
 
         DrawCommand command;
         command.vertices = vertices;
-        command.indices = indices;
+        command.indices = nullptr;
         command.numVertices = 4;
         command.numIndices = 6;
         command.textureId = textureId;
@@ -216,7 +933,41 @@ namespace vexed {
         addVertices(&command);
     }
 
+    void Graphics::addRectangles(const Rectangle *rectangles, size_t count, const Color &color, const Rectangle &clippingRect, uint32_t shaderId, void *userData) {
+        if(rectangles == nullptr || count == 0)
+            return;
+
+        if(instancingEnabled && shaderId == 0) {
+            for(size_t i = 0; i < count; i++)
+                addRectangle(Vector2(rectangles[i].x, rectangles[i].y), Vector2(rectangles[i].width, rectangles[i].height), 0.0f, color, clippingRect, shaderId, userData);
+            return;
+        }
+
+        checkTemporaryVertexBuffer(count * 4);
+
+        Simd::expandRectangles(rectangles, count, color, vertexBufferTemp.data());
+
+        DrawCommand command;
+        command.vertices = vertexBufferTemp.data();
+        command.indices = nullptr;
+        command.numVertices = count * 4;
+        command.numIndices = count * 6;
+        command.textureId = textureId;
+        command.textureIsFont = false;
+        command.shaderId = shaderId;
+        command.clippingRect = clippingRect;
+        command.userData = userData;
+
+        addVertices(&command);
+    }
+
     void Graphics::addCircle(const Vector2 &position, float radius, int segments, float rotationDegrees, const Color &color, const Rectangle &clippingRect, uint32_t shaderId, void *userData) {
+        // The circle is evaluated per fragment, so the number of segments does not matter here. Custom shaders still get the tessellated version
+        if(shaderId == 0) {
+            addShape(Vector2(position.x - radius, position.y - radius), Vector2(radius * 2.0f, radius * 2.0f), rotationDegrees, color, Vector2(-1, 0), clippingRect, userData);
+            return;
+        }
+
         if(segments < 3)
             segments = 3;
 
@@ -230,13 +981,14 @@ namespace vexed {
             float angle = 2.0f * M_PI * i / segments;
             vertexBufferTemp[i].position = Vector2(radius * cos(angle), radius * sin(angle));
             vertexBufferTemp[i].uv = Vector2(0.5f + 0.5f * cos(angle), 0.5f + 0.5f * sin(angle));
-            vertexBufferTemp[i].color = color;
             vertexBufferTemp[i].position.x += position.x;
             vertexBufferTemp[i].position.y += position.y;
         }
 
+        Simd::fillColor(vertexBufferTemp.data(), segments, color);
+
         if(rotationDegrees != 0.0f)
-            rotateVertices(vertexBufferTemp.data(), segments, rotationDegrees);
+            Simd::rotateVertices(vertexBufferTemp.data(), segments, rotationDegrees);
 
         for (int i = 0; i < segments; ++i) {
             indexBufferTemp[i * 3] = 0; // Center vertex (if added at 0 index)
@@ -258,12 +1010,50 @@ namespace vexed {
         addVertices(&command);
     }
 
+    void Graphics::addEllipse(const Vector2 &center, const Vector2 &radii, float rotationDegrees, const Color &color, const Rectangle &clippingRect, void *userData) {
+        addShape(Vector2(center.x - radii.x, center.y - radii.y), Vector2(radii.x * 2.0f, radii.y * 2.0f), rotationDegrees, color, Vector2(-1, 0), clippingRect, userData);
+    }
+
+    void Graphics::addRoundedRectangle(const Vector2 &position, const Vector2 &size, float cornerRadius, float rotationDegrees, const Color &color, const Rectangle &clippingRect, void *userData) {
+        // Without a radius a regular quad does the same job
+        if(cornerRadius <= 0.0f) {
+            addRectangle(position, size, rotationDegrees, color, clippingRect, 0, userData);
+            return;
+        }
+        addShape(position, size, rotationDegrees, color, Vector2(cornerRadius, 0), clippingRect, userData);
+    }
+
+    void Graphics::addRing(const Vector2 &center, float radius, float thickness, const Color &color, const Rectangle &clippingRect, void *userData) {
+        if(thickness <= 0.0f)
+            return;
+        addShape(Vector2(center.x - radius, center.y - radius), Vector2(radius * 2.0f, radius * 2.0f), 0.0f, color, Vector2(-1, thickness), clippingRect, userData);
+    }
+
+    void Graphics::addBorder(const Vector2 &position, const Vector2 &size, float thickness, float cornerRadius, const Color &color, const Rectangle &clippingRect, void *userData) {
+        if(thickness <= 0.0f)
+            return;
+        addShape(position, size, 0.0f, color, Vector2(std::max(cornerRadius, 0.0f), thickness), clippingRect, userData);
+    }
+
     void Graphics::addLine(const Vector2 &p1, const Vector2 &p2, float thickness, const Color &color, const Rectangle &clippingRect, uint32_t shaderId, void *userData) {
         Vector2 direction(p2.x - p1.x, p2.y - p1.y);
         float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
 
         if (length == 0) return;
 
+        if(instancingEnabled && shaderId == 0) {
+            InstanceData instance;
+            instance.position = Vector2((p1.x + p2.x - length) * 0.5f, (p1.y + p2.y - thickness) * 0.5f);
+            instance.size = Vector2(length, thickness);
+            instance.uv0 = Vector2(0, 0);
+            instance.uv1 = Vector2(1, 1);
+            setInstanceColor(instance, color);
+            instance.rotation = std::atan2(direction.y, direction.x);
+            instance.kind = InstanceKind_Rectangle;
+            addInstance(instance, textureId, clippingRect, userData);
+            return;
+        }
+
         direction.x /= length;
         direction.y /= length;
 
@@ -277,14 +1067,9 @@ namespace vexed {
             { Vector2(p2.x + perpendicular.x, p2.y + perpendicular.y), Vector2(1, 1), color }  // Bottom right
         };
 
-        uint32_t indices[6] = {
-            0, 1, 2, 
-            0, 2, 3
-        };
-
         DrawCommand command;
         command.vertices = vertices;
-        command.indices = indices;
+        command.indices = nullptr;
         command.numVertices = 4;
         command.numIndices = 6;
         command.textureId = textureId;
@@ -303,54 +1088,230 @@ namespace vexed {
         if (segments == nullptr) 
             return;
 
+        if(instancingEnabled && shaderId == 0) {
+            for(size_t i = 0; i < count; i++)
+                addLine(segments[i*2+0], segments[i*2+1], thickness, color, clippingRect, shaderId, userData);
+            return;
+        }
+
         size_t requiredVertices = count * 4; // 4 vertices per line
-        size_t requiredIndices = count * 6; // 6 indices per line
 
         checkTemporaryVertexBuffer(requiredVertices);
-        checkTemporaryIndexBuffer(requiredIndices);
 
-        size_t pointCount = count * 2;
-        size_t vertexIndex = 0;
-        size_t indiceIndex = 0;
+        // Segments without length turn into empty quads
+        Simd::extrudeSegments(segments, count, thickness, color, vertexBufferTemp.data());
+
+        DrawCommand command;
+        command.vertices = vertexBufferTemp.data();
+        command.indices = nullptr;
+        command.numVertices = requiredVertices;
+        command.numIndices = count * 6;
+        command.textureId = textureId;
+        command.textureIsFont = false;
+        command.shaderId = shaderId;
+        command.clippingRect = clippingRect;
+        command.userData = userData;
+
+        addVertices(&command);
+    }
 
-        for(size_t i = 0; i < pointCount; i+=2) {
-            Vector2 p1 = segments[i+0];
-            Vector2 p2 = segments[i+1];
+    // Number of triangles for an arc, so the chords stay within a quarter pixel of the circle
+    static size_t getRoundSteps(float radius, float angle, size_t maxSteps) {
+        if(radius <= 0.25f)
+            return 1;
+        const float stepAngle = 2.0f * std::acos(1.0f - 0.25f / radius);
+        const size_t steps = static_cast<size_t>(std::ceil(std::fabs(angle) / stepAngle));
+        return std::max<size_t>(1, std::min(steps, maxSteps));
+    }
 
-            Vector2 direction(p2.x - p1.x, p2.y - p1.y);
+    void Graphics::addPolyline(const Vector2 *points, size_t count, float thickness, LineJoin join, LineCap cap, const Color &color, const Rectangle &clippingRect, uint32_t shaderId, void *userData) {
+        if (points == nullptr || count < 2 || thickness <= 0.0f)
+            return;
 
-            float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+        // Repeated points have no direction, so they are dropped along with NaN points
+        pointBufferTemp.clear();
+        float totalLength = 0.0f;
 
-            if (length == 0) 
-                return;
+        for(size_t i = 0; i < count; i++) {
+            const Vector2 &point = points[i];
+            if (point.x != point.x || point.y != point.y)
+                continue;
+            if (!pointBufferTemp.empty()) {
+                const Vector2 &last = pointBufferTemp.back();
+                if (last.x == point.x && last.y == point.y)
+                    continue;
+                totalLength += std::sqrt((point.x - last.x) * (point.x - last.x) + (point.y - last.y) * (point.y - last.y));
+            }
+            pointBufferTemp.push_back(point);
+        }
 
-            direction.x /= length;
-            direction.y /= length;
+        const size_t numPoints = pointBufferTemp.size();
 
-            Vector2 perpendicular = Vector2(-direction.y * thickness * 0.5f, 
-                                            direction.x * thickness * 0.5f);
+        if (numPoints < 2)
+            return;
 
-            vertexBufferTemp[vertexIndex+0] = { Vector2(p1.x + perpendicular.x, p1.y + perpendicular.y), Vector2(0, 1), color };
-            vertexBufferTemp[vertexIndex+1] = { Vector2(p1.x - perpendicular.x, p1.y - perpendicular.y), Vector2(0, 0), color };
-            vertexBufferTemp[vertexIndex+2] = { Vector2(p2.x - perpendicular.x, p2.y - perpendicular.y), Vector2(1, 0), color };
-            vertexBufferTemp[vertexIndex+3] = { Vector2(p2.x + perpendicular.x, p2.y + perpendicular.y), Vector2(1, 1), color };
+        const Vector2 *p = pointBufferTemp.data();
+        const float halfThickness = thickness * 0.5f;
 
-            indexBufferTemp[indiceIndex+0] = 0 + vertexIndex;
-            indexBufferTemp[indiceIndex+1] = 1 + vertexIndex;
-            indexBufferTemp[indiceIndex+2] = 2 + vertexIndex;
-            indexBufferTemp[indiceIndex+3] = 0 + vertexIndex;
-            indexBufferTemp[indiceIndex+4] = 2 + vertexIndex;
-            indexBufferTemp[indiceIndex+5] = 3 + vertexIndex;
+        // Worst case is a round join at every point and round caps at both ends
+        checkTemporaryVertexBuffer(numPoints * (4 + POLYLINE_MAX_ROUND_STEPS) + 2 * (3 + POLYLINE_MAX_ROUND_STEPS));
+        checkTemporaryIndexBuffer(numPoints * (12 + 3 * POLYLINE_MAX_ROUND_STEPS) + 6 * POLYLINE_MAX_ROUND_STEPS);
 
-            vertexIndex += 4;
-            indiceIndex += 6;
+        Vertex *vertices = vertexBufferTemp.data();
+        uint32_t *indices = indexBufferTemp.data();
+        size_t numVertices = 0;
+        size_t numIndices = 0;
+        float distance = 0.0f;
+
+        // The uv runs along the line in x and across it in y, like the quads of 'addLine'
+        auto addVertex = [&] (const Vector2 &position, float side) {
+            vertices[numVertices] = Vertex(position, Vector2(distance / totalLength, side), color);
+            return static_cast<uint32_t>(numVertices++);
+        };
+
+        auto addTriangle = [&] (uint32_t a, uint32_t b, uint32_t c) {
+            indices[numIndices++] = a;
+            indices[numIndices++] = b;
+            indices[numIndices++] = c;
+        };
+
+        auto addQuad = [&] (uint32_t left1, uint32_t right1, uint32_t left2, uint32_t right2) {
+            addTriangle(left1, right1, right2);
+            addTriangle(left1, right2, left2);
+        };
+
+        // Fan around the center from the vertex 'first' to the vertex 'last', which lie on the circle
+        auto addArc = [&] (const Vector2 &center, uint32_t centerIndex, uint32_t first, uint32_t last, float angle, float side) {
+            const size_t steps = getRoundSteps(halfThickness, angle, POLYLINE_MAX_ROUND_STEPS);
+            const float fromX = vertices[first].position.x - center.x;
+            const float fromY = vertices[first].position.y - center.y;
+            uint32_t previous = first;
+
+            for(size_t i = 1; i < steps; i++) {
+                const float a = angle * i / steps;
+                const float c = std::cos(a);
+                const float s = std::sin(a);
+                const uint32_t next = addVertex(Vector2(center.x + fromX * c - fromY * s, center.y + fromX * s + fromY * c), side);
+                addTriangle(centerIndex, previous, next);
+                previous = next;
+            }
+
+            addTriangle(centerIndex, previous, last);
+        };
+
+        auto getDirection = [&] (size_t segment, float &length) {
+            const float dx = p[segment+1].x - p[segment].x;
+            const float dy = p[segment+1].y - p[segment].y;
+            length = std::sqrt(dx * dx + dy * dy);
+            return Vector2(dx / length, dy / length);
+        };
+
+        float length;
+        Vector2 direction = getDirection(0, length);
+        Vector2 normal(-direction.y * halfThickness, direction.x * halfThickness);
+        Vector2 start = p[0];
+
+        if (cap == LineCap_Square)
+            start = Vector2(start.x - direction.x * halfThickness, start.y - direction.y * halfThickness);
+
+        uint32_t left = addVertex(Vector2(start.x + normal.x, start.y + normal.y), 1.0f);
+        uint32_t right = addVertex(Vector2(start.x - normal.x, start.y - normal.y), 0.0f);
+
+        if (cap == LineCap_Round)
+            addArc(p[0], addVertex(p[0], 0.5f), right, left, -M_PI, 0.5f);
+
+        for(size_t i = 1; i < numPoints - 1; i++) {
+            distance += length;
+
+            const Vector2 &point = p[i];
+            const Vector2 d0 = direction;
+            const Vector2 n0 = normal;
+            const float length0 = length;
+
+            direction = getDirection(i, length);
+            normal = Vector2(-direction.y * halfThickness, direction.x * halfThickness);
+
+            const float cross = d0.x * direction.y - d0.y * direction.x;
+            const float dot = d0.x * direction.x + d0.y * direction.y;
+
+            // The line turns back onto itself, there is no miter to share
+            if (dot < 0.0f && std::fabs(cross) < 1e-6f) {
+                const uint32_t endLeft = addVertex(Vector2(point.x + n0.x, point.y + n0.y), 1.0f);
+                const uint32_t endRight = addVertex(Vector2(point.x - n0.x, point.y - n0.y), 0.0f);
+                addQuad(left, right, endLeft, endRight);
+                left = addVertex(Vector2(point.x + normal.x, point.y + normal.y), 1.0f);
+                right = addVertex(Vector2(point.x - normal.x, point.y - normal.y), 0.0f);
+                if (join == LineJoin_Round)
+                    addArc(point, addVertex(point, 0.5f), endLeft, left, -M_PI, 0.5f);
+                continue;
+            }
+
+            // The miter points along the sum of both normals, its length grows as the turn gets sharper
+            Vector2 miter(n0.x + normal.x, n0.y + normal.y);
+            const float miterNorm = std::sqrt(miter.x * miter.x + miter.y * miter.y);
+            miter = Vector2(miter.x / miterNorm, miter.y / miterNorm);
+            const float miterLength = halfThickness * halfThickness / (miter.x * n0.x + miter.y * n0.y);
+
+            // The inner point must not move past the other end of a short segment
+            const float along = std::fabs(miter.x * d0.x + miter.y * d0.y);
+            const float innerLimit = along > 1e-6f ? std::min(length0, length) / along : FLT_MAX;
+
+            if (join == LineJoin_Miter && miterLength <= POLYLINE_MITER_LIMIT * halfThickness && miterLength <= innerLimit) {
+                const uint32_t nextLeft = addVertex(Vector2(point.x + miter.x * miterLength, point.y + miter.y * miterLength), 1.0f);
+                const uint32_t nextRight = addVertex(Vector2(point.x - miter.x * miterLength, point.y - miter.y * miterLength), 0.0f);
+                addQuad(left, right, nextLeft, nextRight);
+                left = nextLeft;
+                right = nextRight;
+                continue;
+            }
+
+            // The inner side shares one vertex, the outer side gets the end of one and the start of the other segment
+            const float side = cross > 0.0f ? 1.0f : -1.0f; //Positive when the left side is the inner side
+            const float innerLength = std::min(miterLength, innerLimit);
+            const uint32_t inner = addVertex(Vector2(point.x + miter.x * innerLength * side, point.y + miter.y * innerLength * side), side > 0.0f ? 1.0f : 0.0f);
+            const float outerSide = side > 0.0f ? 0.0f : 1.0f;
+            const uint32_t outerEnd = addVertex(Vector2(point.x - n0.x * side, point.y - n0.y * side), outerSide);
+            const uint32_t outerStart = addVertex(Vector2(point.x - normal.x * side, point.y - normal.y * side), outerSide);
+
+            if (side > 0.0f) {
+                addQuad(left, right, inner, outerEnd);
+                left = inner;
+                right = outerStart;
+            } else {
+                addQuad(left, right, outerEnd, inner);
+                left = outerStart;
+                right = inner;
+            }
+
+            if (join == LineJoin_Round) {
+                const uint32_t center = addVertex(point, 0.5f);
+                addTriangle(inner, outerEnd, center);
+                addTriangle(inner, center, outerStart);
+                addArc(point, center, outerEnd, outerStart, std::atan2(cross, dot), outerSide);
+            } else {
+                addTriangle(inner, outerEnd, outerStart);
+            }
         }
 
+        distance = totalLength;
+
+        Vector2 end = p[numPoints-1];
+
+        if (cap == LineCap_Square)
+            end = Vector2(end.x + direction.x * halfThickness, end.y + direction.y * halfThickness);
+
+        const uint32_t endLeft = addVertex(Vector2(end.x + normal.x, end.y + normal.y), 1.0f);
+        const uint32_t endRight = addVertex(Vector2(end.x - normal.x, end.y - normal.y), 0.0f);
+        addQuad(left, right, endLeft, endRight);
+
+        if (cap == LineCap_Round)
+            addArc(p[numPoints-1], addVertex(p[numPoints-1], 0.5f), endLeft, endRight, -M_PI, 0.5f);
+
         DrawCommand command;
-        command.vertices = vertexBufferTemp.data();
-        command.indices = indexBufferTemp.data();
-        command.numVertices = requiredVertices;
-        command.numIndices = requiredIndices;
+        command.vertices = vertices;
+        command.indices = indices;
+        command.numVertices = numVertices;
+        command.numIndices = numIndices;
         command.textureId = textureId;
         command.textureIsFont = false;
         command.shaderId = shaderId;
@@ -360,7 +1321,7 @@ namespace vexed {
         addVertices(&command);
     }
 
-    void Graphics::addPlotLines(const Vector2 &position, const Vector2 &size, const float *data, int valuesCount, float thickness, const Color &color, float scaleMin, float scaleMax, const Rectangle &clippingRect, uint32_t shaderId, void *userData) {
+    void Graphics::addPlotLines(const Vector2 &position, const Vector2 &size, const float *data, int valuesCount, float thickness, const Color &color, float scaleMin, float scaleMax, const Rectangle &clippingRect, uint32_t shaderId, void *userData, PlotLinesMode mode) {
         if (valuesCount < 2) 
             return;
 
@@ -369,7 +1330,6 @@ namespace vexed {
 
         size_t count = valuesCount - 1;
         size_t requiredVertices = count * 4; // 4 vertices per line
-        size_t requiredIndices = count * 6; // 6 indices per line
         float plotWidth = size.x;
         float plotHeight = size.y;
         float step = plotWidth / valuesCount;
@@ -399,56 +1359,38 @@ namespace vexed {
             return (x - scaleMin) / (scaleMax - scaleMin); // Normalized to [0, 1]
         };
 
+        if (mode == PlotLinesMode_Polyline) {
+            if(segmentBufferTemp.size() < static_cast<size_t>(valuesCount))
+                segmentBufferTemp.resize(valuesCount);
+
+            for(size_t i = 0; i < static_cast<size_t>(valuesCount); i++)
+                segmentBufferTemp[i] = Vector2(position.x + (i * step), position.y + (normalize(data[i], scaleMin, scaleMax) * plotHeight));
+
+            addPolyline(segmentBufferTemp.data(), valuesCount, thickness, LineJoin_Miter, LineCap_Butt, color, clippingRect, shaderId, userData);
+            return;
+        }
+
         checkTemporaryVertexBuffer(requiredVertices);
-        checkTemporaryIndexBuffer(requiredIndices);
 
-        size_t pointCount = count * 2;
-        size_t vertexIndex = 0;
-        size_t indiceIndex = 0;
+        if(segmentBufferTemp.size() < count * 2)
+            segmentBufferTemp.resize(count * 2);
 
-        for(size_t i = 0; i < valuesCount -1; i++) {
+        for(size_t i = 0; i < count; i++) {
             float x1 = position.x + ((i+0) * step);
             float x2 = position.x + ((i+1) * step);
             float y1 = position.y + (normalize(data[i], scaleMin, scaleMax) * plotHeight);
             float y2 = position.y + (normalize(data[i+1], scaleMin, scaleMax) * plotHeight);
-
-            Vector2 p1(x1, y1);
-            Vector2 p2(x2, y2);
-
-            Vector2 direction(p2.x - p1.x, p2.y - p1.y);
-
-            float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
-
-            if (length == 0) 
-                return;
-
-            direction.x /= length;
-            direction.y /= length;
-
-            Vector2 perpendicular(-direction.y * thickness * 0.5f, 
-                                   direction.x * thickness * 0.5f);
-
-            vertexBufferTemp[vertexIndex+0] = { Vector2(p1.x + perpendicular.x, p1.y + perpendicular.y), Vector2(0, 1), color };
-            vertexBufferTemp[vertexIndex+1] = { Vector2(p1.x - perpendicular.x, p1.y - perpendicular.y), Vector2(0, 0), color };
-            vertexBufferTemp[vertexIndex+2] = { Vector2(p2.x - perpendicular.x, p2.y - perpendicular.y), Vector2(1, 0), color };
-            vertexBufferTemp[vertexIndex+3] = { Vector2(p2.x + perpendicular.x, p2.y + perpendicular.y), Vector2(1, 1), color };
-
-            indexBufferTemp[indiceIndex+0] = 0 + vertexIndex;
-            indexBufferTemp[indiceIndex+1] = 1 + vertexIndex;
-            indexBufferTemp[indiceIndex+2] = 2 + vertexIndex;
-            indexBufferTemp[indiceIndex+3] = 0 + vertexIndex;
-            indexBufferTemp[indiceIndex+4] = 2 + vertexIndex;
-            indexBufferTemp[indiceIndex+5] = 3 + vertexIndex;
-
-            vertexIndex += 4;
-            indiceIndex += 6;
+            segmentBufferTemp[i*2+0] = Vector2(x1, y1);
+            segmentBufferTemp[i*2+1] = Vector2(x2, y2);
         }
 
+        Simd::extrudeSegments(segmentBufferTemp.data(), count, thickness, color, vertexBufferTemp.data());
+
         DrawCommand command;
         command.vertices = vertexBufferTemp.data();
-        command.indices = indexBufferTemp.data();
+        command.indices = nullptr;
         command.numVertices = requiredVertices;
-        command.numIndices = requiredIndices;
+        command.numIndices = count * 6;
         command.textureId = textureId;
         command.textureIsFont = false;
         command.shaderId = shaderId;
@@ -489,7 +1431,7 @@ namespace vexed {
         };
 
         if(rotationDegrees != 0.0f)
-            rotateVertices(vertices, 3, rotationDegrees);
+            Simd::rotateVertices(vertices, 3, rotationDegrees);
 
         uint32_t indices[3] = {
             0, 1, 2, 
@@ -557,13 +1499,18 @@ namespace vexed {
         if(text.size() == 0)
             return;
 
+        const Rectangle clip = getEffectiveClip(clippingRect);
+        const bool culling = !clip.isZero();
+
+        if(culling && (clip.width <= 0.0f || clip.height <= 0.0f))
+            return;
+
         size_t requiredVertices = text.size() * 4; // 4 vertices per character
-        size_t requiredIndices = text.size() * 6; // 6 indices per character
 
         checkTemporaryVertexBuffer(requiredVertices);
-        checkTemporaryIndexBuffer(requiredIndices);
 
         float size = fontSize / font->getPixelSize();
+        const float lineHeight = font->getLineHeight() * size;
         Vector2 pos(position.x, position.y);
         pos.y += font->getLineHeight() * size;
         float originX = pos.x;
@@ -574,7 +1521,6 @@ namespace vexed {
         uint32_t codePointOfFirstChar = font->getCodePointOfFirstChar();
 
         size_t vertexIndex = 0;
-        size_t indiceIndex = 0;
 
         constexpr size_t colorSize = 128;
         TextColorInfo textColorInfo[colorSize];
@@ -599,7 +1545,10 @@ namespace vexed {
 
             if(ch == '\n') {
                 pos.x = originX;
-                pos.y += font->getLineHeight() * size;
+                pos.y += lineHeight;
+                // Lines only move down, nothing after a line that starts below the clip can be visible
+                if(culling && pos.y - lineHeight >= clip.y + clip.height)
+                    break;
                 continue;
             }
 
@@ -644,29 +1593,30 @@ namespace vexed {
                 }
             }
 
+            if(culling) {
+                const float left = glyphBoundingBoxBottomLeft.x;
+                const float top = glyphBoundingBoxBottomLeft.y - glyphSize.y;
+                if(left + glyphSize.x <= clip.x || left >= clip.x + clip.width || glyphBoundingBoxBottomLeft.y <= clip.y || top >= clip.y + clip.height) {
+                    pos.x += packedChar->xadvance * size;
+                    continue;
+                }
+            }
+
             vertexBufferTemp[vertexIndex+0] = { Vector2(glyphVertices[0].x, glyphVertices[0].y), glyphTextureCoords[0], currentColor };
             vertexBufferTemp[vertexIndex+1] = { Vector2(glyphVertices[1].x, glyphVertices[1].y), glyphTextureCoords[1], currentColor };
             vertexBufferTemp[vertexIndex+2] = { Vector2(glyphVertices[2].x, glyphVertices[2].y), glyphTextureCoords[2], currentColor };
             vertexBufferTemp[vertexIndex+3] = { Vector2(glyphVertices[3].x, glyphVertices[3].y), glyphTextureCoords[3], currentColor };
 
-            indexBufferTemp[indiceIndex+0] = 0 + vertexIndex;
-            indexBufferTemp[indiceIndex+1] = 1 + vertexIndex;
-            indexBufferTemp[indiceIndex+2] = 2 + vertexIndex;
-            indexBufferTemp[indiceIndex+3] = 0 + vertexIndex;
-            indexBufferTemp[indiceIndex+4] = 2 + vertexIndex;
-            indexBufferTemp[indiceIndex+5] = 3 + vertexIndex;
-
             vertexIndex += 4;
-            indiceIndex += 6;
 
             pos.x += packedChar->xadvance * size;
         }
 
         DrawCommand command;
         command.vertices = vertexBufferTemp.data();
-        command.indices = indexBufferTemp.data();
+        command.indices = nullptr;
         command.numVertices = vertexIndex;
-        command.numIndices = indiceIndex;
+        command.numIndices = (vertexIndex / 4) * 6;
         command.textureId = font->getTexture();
         command.textureIsFont = true;
         command.shaderId = this->shaderId;
@@ -677,6 +1627,19 @@ namespace vexed {
     }
 
     void Graphics::addImage(const Vector2 &position, const Vector2 &size, float rotationDegrees, uint32_t textureId, const Color &color, const Vector2 &uv0, const Vector2 &uv1, const Rectangle &clippingRect, uint32_t shaderId, void *userData) {
+        if(instancingEnabled && shaderId == 0) {
+            InstanceData instance;
+            instance.position = position;
+            instance.size = size;
+            instance.uv0 = uv0;
+            instance.uv1 = uv1;
+            setInstanceColor(instance, color);
+            instance.rotation = rotationDegrees * (M_PI / 180.0f);
+            instance.kind = InstanceKind_Rectangle;
+            addInstance(instance, textureId, clippingRect, userData);
+            return;
+        }
+
         Vector2 uvTopLeft = Vector2(uv0.x, uv0.y);
         Vector2 uvBottomLeft = Vector2(uv0.x, uv1.y);
         Vector2 uvBottomRight = Vector2(uv1.x, uv1.y);
@@ -690,16 +1653,11 @@ namespace vexed {
         };
 
         if(rotationDegrees != 0.0f)
-            rotateVertices(vertices, 4, rotationDegrees);
-
-        uint32_t indices[6] = {
-            0, 1, 2, 
-            0, 2, 3
-        };
+            Simd::rotateVertices(vertices, 4, rotationDegrees);
 
         DrawCommand command;
         command.vertices = vertices;
-        command.indices = indices;
+        command.indices = nullptr;
         command.numVertices = 4;
         command.numIndices = 6;
         command.textureId = textureId;
@@ -711,290 +1669,1855 @@ namespace vexed {
         addVertices(&command);
     }
 
-    void Graphics::setViewport(uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
-        glViewport(0, 0, width, height);
-        viewport.x = x;
-        viewport.y = y;
-        viewport.width = width;
-        viewport.height = height;
-    }
+    void Graphics::addImage(const Vector2 &position, const Vector2 &size, float rotationDegrees, const Atlas *atlas, uint32_t regionHandle, const Color &color, const Vector2 &uv0, const Vector2 &uv1, const Rectangle &clippingRect, uint32_t shaderId, void *userData) {
+        AtlasRegion region;
 
-    void Graphics::setClearColor(const Color &color) {
-        this->clearColor = color;
+        if(!atlas || !atlas->getRegion(regionHandle, region))
+            return;
+
+        const Vector2 regionSize(region.uv1.x - region.uv0.x, region.uv1.y - region.uv0.y);
+        const Vector2 atlasUV0(region.uv0.x + (uv0.x * regionSize.x), region.uv0.y + (uv0.y * regionSize.y));
+        const Vector2 atlasUV1(region.uv0.x + (uv1.x * regionSize.x), region.uv0.y + (uv1.y * regionSize.y));
+
+        addImage(position, size, rotationDegrees, region.textureId, color, atlasUV0, atlasUV1, clippingRect, shaderId, userData);
     }
 
-    void Graphics::checkVertexBuffer(size_t numRequiredVertices) {
-        size_t verticesNeeded = vertexCount + numRequiredVertices;
-        
-        if(verticesNeeded > vertices.size()) {
-            size_t newSize = vertices.size() * 2;
-            while(newSize < verticesNeeded) {
-                newSize *= 2;
-            }
-            vertices.resize(newSize);
-            glBindBuffer(GL_ARRAY_BUFFER, VBO);
-            glBufferData(GL_ARRAY_BUFFER, newSize * sizeof(Vertex), nullptr, GL_DYNAMIC_DRAW);
-            glBindBuffer(GL_ARRAY_BUFFER, 0);
+    // Everything added until endDrawList goes into the draw list instead of the current frame
+    bool Graphics::beginDrawList(DrawList *drawList) {
+        if(drawList == nullptr)
+            return false;
+
+        if(recordingList) {
+            std::cerr << "Graphics::beginDrawList called while another draw list is being recorded" << std::endl;
+            return false;
         }
+
+        drawList->invalidate();
+
+        // Keeps the indices of the list aligned for either index type
+        indexByteCount = (indexByteCount + 3) & ~static_cast<size_t>(3);
+
+        recordingList = drawList;
+        recordItemOffset = itemCount;
+        recordVertexOffset = vertexCount;
+        recordIndexOffset = indexByteCount;
+        recordInstanceOffset = instanceCount;
+        return true;
     }
 
-    void Graphics::checkIndexBuffer(size_t numRequiredIndices) {
-        size_t indicesNeeded = indiceCount + numRequiredIndices;
-        
-        if(indicesNeeded > indices.size()) {
-            size_t newSize = indices.size() * 2;
-            while(newSize < indicesNeeded) {
-                newSize *= 2;
-            }
-            indices.resize(newSize);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, newSize * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    // Moves the recorded geometry into the buffers of the draw list and removes it from the current frame
+    void Graphics::endDrawList() {
+        if(recordingList == nullptr) {
+            std::cerr << "Graphics::endDrawList called without a matching beginDrawList" << std::endl;
+            return;
         }
-    }
 
-    void Graphics::checkItemBuffer(size_t numRequiredItems) {
-        size_t itemsNeeded = itemCount + numRequiredItems;
+        DrawList *drawList = recordingList;
+        const size_t numItems = itemCount - recordItemOffset;
 
-        if(itemsNeeded > items.size()) {
-            size_t newSize = items.size() * 2;
-            while(newSize < itemsNeeded) {
-                newSize *= 2;
-            }
-            items.resize(newSize);
+        drawList->items.assign(items.begin() + recordItemOffset, items.begin() + itemCount);
+        drawList->bounds = Rectangle(0, 0, 0, 0);
+
+        for(size_t i = 0; i < numItems; i++) {
+            DrawListItem &item = drawList->items[i];
+            item.vertexOffset -= recordVertexOffset;
+            item.indiceOffset -= recordIndexOffset;
+            item.instanceOffset = item.instanceCount > 0 ? item.instanceOffset - recordInstanceOffset : 0;
+
+            // Clipping rectangles are flipped again on replay, when the viewport may have changed
+            Rectangle &rect = item.clippingRect;
+            if(!rect.isZero())
+                rect.y = viewport.height - rect.y - rect.height;
+
+            drawList->bounds = i == 0 ? item.bounds : unite(drawList->bounds, item.bounds);
         }
+
+        batchItems(drawList->items.data(), numItems, drawList->batches);
+
+        uploadDrawList(drawList);
+
+        itemCount = recordItemOffset;
+        vertexCount = recordVertexOffset;
+        indexByteCount = recordIndexOffset;
+        instanceCount = recordInstanceOffset;
+
+        recordingList = nullptr;
+        recordItemOffset = 0;
+
+        drawList->valid = true;
     }
 
-    void Graphics::checkTemporaryVertexBuffer(size_t numRequiredVertices) {
-        if(vertexBufferTemp.size() < numRequiredVertices) {
-            size_t newSize = vertexBufferTemp.size() * 2;
-            while(newSize < numRequiredVertices) {
-                newSize *= 2;
-            }                
-            vertexBufferTemp.resize(newSize);
+    // Copies the recorded range of the staging vectors into the static buffers of the draw list
+    void Graphics::uploadDrawList(DrawList *drawList) {
+        const uint8_t *recordedVertices = vertices.data() + (recordVertexOffset * vertexStride);
+        const uint8_t *recordedIndices = indices.data() + recordIndexOffset;
+        const size_t numVertexBytes = (vertexCount - recordVertexOffset) * vertexStride;
+        const size_t numIndexBytes = indexByteCount - recordIndexOffset;
+        const size_t numInstances = instanceCount - recordInstanceOffset;
+
+        if(drawList->VAO == 0) {
+            glGenVertexArrays(1, &drawList->VAO);
+            drawList->VBO = backend->createBuffer();
+            drawList->EBO = backend->createBuffer();
         }
-    }
 
-    void Graphics::checkTemporaryIndexBuffer(size_t numRequiredIndices) {
-        if(indexBufferTemp.size() < (numRequiredIndices)) {
-            size_t newSize = indexBufferTemp.size() * 2;
-            while(newSize < numRequiredIndices) {
-                newSize *= 2;
+        drawList->vertexFormat = vertexFormat;
+
+        stateCache.bindVertexArray(drawList->VAO);
+        stateCache.bindBuffer(GL_ARRAY_BUFFER, drawList->VBO);
+        stateCache.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, drawList->EBO);
+
+        backend->allocateBuffer(drawList->VBO, numVertexBytes, recordedVertices, BufferUsage_Static);
+        backend->allocateBuffer(drawList->EBO, QUAD_PATTERN_SIZE + numIndexBytes, nullptr, BufferUsage_Static);
+        backend->copyBuffer(quadPatternBuffer, drawList->EBO, 0, 0, QUAD_PATTERN_SIZE);
+        if(numIndexBytes > 0)
+            backend->updateBuffer(drawList->EBO, QUAD_PATTERN_SIZE, numIndexBytes, recordedIndices);
+
+        setVertexAttributes(drawList->vertexFormat);
+
+        if(numInstances > 0) {
+            if(drawList->instanceVAO == 0) {
+                glGenVertexArrays(1, &drawList->instanceVAO);
+                drawList->instanceVBO = backend->createBuffer();
             }
-            indexBufferTemp.resize(newSize);
-        }
-    }
 
-    void Graphics::addVertices(const DrawCommand *command) {
-        checkVertexBuffer(command->numVertices);
-        checkIndexBuffer(command->numIndices);
-        checkItemBuffer(1);
+            // Shares the unit quad with the frame, only the per-instance data belongs to the list
+            stateCache.bindVertexArray(drawList->instanceVAO);
 
-        memcpy(&vertices[vertexCount], &command->vertices[0], command->numVertices * sizeof(Vertex));
+            stateCache.bindBuffer(GL_ARRAY_BUFFER, quadVBO);
+            glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (GLvoid*)0);
+            glEnableVertexAttribArray(0);
 
-        for(size_t i = 0; i < command->numIndices; i++) {
-            indices[indiceCount+i] = command->indices[i] + vertexCount;
-        }
+            stateCache.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadEBO);
 
-        items[itemCount].vertexCount = command->numVertices;
-        items[itemCount].indiceCount = command->numIndices;
-        items[itemCount].vertexOffset = vertexCount;
-        items[itemCount].indiceOffset = indiceCount;
-        items[itemCount].shaderId = command->shaderId == 0 ? this->shaderId : command->shaderId;
-        items[itemCount].textureId = command->textureId;
-        items[itemCount].textureIsFont = command->textureIsFont;
-        items[itemCount].clippingRect = command->clippingRect;
-        items[itemCount].userData = command->userData;
+            stateCache.bindBuffer(GL_ARRAY_BUFFER, drawList->instanceVBO);
+            backend->allocateBuffer(drawList->instanceVBO, numInstances * sizeof(InstanceData), &instances[recordInstanceOffset], BufferUsage_Static);
 
-        Rectangle &rect = items[itemCount].clippingRect;
+            for(uint32_t i = 1; i <= 8; i++) {
+                glEnableVertexAttribArray(i);
+                glVertexAttribDivisor(i, 1);
+            }
 
-        if(!rect.isZero()) {
-            rect.y = viewport.height - rect.y - rect.height;
+            setInstanceAttributes(drawList->instanceVBO, 0);
         }
 
-        itemCount++;
-        vertexCount += command->numVertices;
-        indiceCount += command->numIndices;
+        numUploadedBytes += numVertexBytes + numIndexBytes + numInstances * sizeof(InstanceData);
+
+        stateCache.bindVertexArray(0);
+        stateCache.bindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
-    void Graphics::rotateVertices(Vertex *vertices, size_t numVertices, float angleDegrees) {
-        float centerX = 0.0f;
-        float centerY = 0.0f;
+    // Rotation is around the origin of the space the list was recorded in, followed by the translation
+    // Clipping rectangles of the recorded items only follow the translation and scale
+    void Graphics::addDrawList(const DrawList *drawList, const Vector2 &translation, const Vector2 &scale, float rotationDegrees, const Rectangle &clippingRect) {
+        if(drawList == nullptr || !drawList->isValid() || drawList->batches.size() == 0)
+            return;
 
-        for (size_t i = 0; i < numVertices; ++i) {
-            centerX += vertices[i].position.x;
-            centerY += vertices[i].position.y;
+        if(recordingList) {
+            std::cerr << "Graphics::addDrawList can not be used while recording a draw list" << std::endl;
+            return;
         }
 
-        centerX /= numVertices;
-        centerY /= numVertices;
+        const Rectangle clip = getEffectiveClip(clippingRect);
 
-        float radians = angleDegrees * (M_PI / 180.0f);
-        float cosAngle = cos(radians);
-        float sinAngle = sin(radians);
+        if(!clip.isZero() && (clip.width <= 0.0f || clip.height <= 0.0f))
+            return;
 
-        for (size_t i = 0; i < numVertices; ++i) {
-            float translatedX = vertices[i].position.x - centerX;
-            float translatedY = vertices[i].position.y - centerY;
+        if(replays.size() <= replayCount)
+            replays.resize(replayCount + 1);
 
-            float rotatedX = translatedX * cosAngle - translatedY * sinAngle;
-            float rotatedY = translatedX * sinAngle + translatedY * cosAngle;
+        DrawListReplay &replay = replays[replayCount];
+        replay.drawList = drawList;
+        replay.clippingRect = clip;
 
-            vertices[i].position.x = rotatedX + centerX;
-            vertices[i].position.y = rotatedY + centerY;
-        }
-    }
+        const float radians = rotationDegrees * (M_PI / 180.0f);
+        const float c = std::cos(radians);
+        const float s = std::sin(radians);
 
-    void Graphics::createBuffers() {
-        constexpr size_t size = 2 << 15;
-        items.resize(size);
-        vertices.resize(size);
-        indices.resize(size);
-        vertexBufferTemp.resize(size);
-        indexBufferTemp.resize(size);
+        const float model[16] = {
+            c * scale.x,   s * scale.x,   0.0f, 0.0f,
+            -s * scale.y,  c * scale.y,   0.0f, 0.0f,
+            0.0f,          0.0f,          1.0f, 0.0f,
+            translation.x, translation.y, 0.0f, 1.0f
+        };
 
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
+        memcpy(replay.model, model, sizeof(model));
 
-        glBindVertexArray(VAO);
+        // Screen space bounds of the transformed list, used for sorting
+        const Rectangle &b = drawList->bounds;
+        const Vector2 corners[4] = {
+            Vector2(b.x, b.y), Vector2(b.x + b.width, b.y), Vector2(b.x, b.y + b.height), Vector2(b.x + b.width, b.y + b.height)
+        };
 
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        Vector2 min(FLT_MAX, FLT_MAX);
+        Vector2 max(-FLT_MAX, -FLT_MAX);
 
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), nullptr, GL_DYNAMIC_DRAW);
+        for(size_t i = 0; i < 4; i++) {
+            const float x = model[0] * corners[i].x + model[4] * corners[i].y + model[12];
+            const float y = model[1] * corners[i].x + model[5] * corners[i].y + model[13];
+            min.x = std::min(min.x, x);
+            min.y = std::min(min.y, y);
+            max.x = std::max(max.x, x);
+            max.y = std::max(max.y, y);
+        }
 
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid*)offsetof(Vertex, position));
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid*)offsetof(Vertex, uv));
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid*)offsetof(Vertex, color));
-        glEnableVertexAttribArray(2);
+        checkItemBuffer(1);
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+        DrawListItem &item = items[itemCount];
+        item.shaderId = 0;
+        item.textureId = 0;
+        item.vertexOffset = 0;
+        item.vertexCount = 0;
+        item.indiceOffset = 0;
+        item.indiceCount = 0;
+        item.instanceOffset = 0;
+        item.instanceCount = 0;
+        item.indexSize = sizeof(uint16_t);
+        item.quads = false;
+        item.textureIsFont = false;
+        item.premultiplied = false;
+        item.clippingRect = Rectangle(0, 0, 0, 0);
+        item.userData = nullptr;
+        item.bounds = clipBounds(Rectangle(min.x, min.y, max.x - min.x, max.y - min.y), clip);
+        item.layer = layer;
+        item.replay = replayCount;
+        item.plot = DrawListItem::NO_PLOT;
+
+        if(layer != 0)
+            layersUsed = true;
 
-        glBindVertexArray(0);
+        itemCount++;
+        replayCount++;
     }
 
-    static bool checkShader(uint32_t handle, const char* desc) {
-        GLint status = 0, log_length = 0;
-        glGetShaderiv(handle, GL_COMPILE_STATUS, &status);
-        glGetShaderiv(handle, GL_INFO_LOG_LENGTH, &log_length);
-        if ((GLboolean)status == GL_FALSE)
-            fprintf(stderr, "ERROR: failed to compile %s!\n", desc);
-        if (log_length > 1) {
-            std::vector<char> buf;
-            buf.resize((int)(log_length + 1));
-            glGetShaderInfoLog(handle, log_length, nullptr, &buf[0]);
-            fprintf(stderr, "%s\n", buf.begin());
-        }
-
-        return (GLboolean)status == GL_TRUE;
-    }
+    // Draws the batches of a draw list from its own buffers, expects the frame state to be set up
+    void Graphics::replayDrawList(const DrawListItem &item) {
+        const DrawListReplay &replay = replays[item.replay];
+        const DrawList *drawList = replay.drawList;
+        const float scaleX = replay.model[0] * replay.model[0] + replay.model[1] * replay.model[1];
+        const float scaleY = replay.model[4] * replay.model[4] + replay.model[5] * replay.model[5];
+        const Vector2 scale(std::sqrt(scaleX), std::sqrt(scaleY));
+        const Vector2 translation(replay.model[12], replay.model[13]);
 
-    static bool checkProgram(GLuint handle, const char* desc) {
-        GLint status = 0, log_length = 0;
-        glGetProgramiv(handle, GL_LINK_STATUS, &status);
-        glGetProgramiv(handle, GL_INFO_LOG_LENGTH, &log_length);
-        if ((GLboolean)status == GL_FALSE)
-            fprintf(stderr, "ERROR: failed to link %s!n", desc);
-        if (log_length > 1) {
-            std::vector<char> buf;
-            buf.resize((int)(log_length + 1));
-            glGetProgramInfoLog(handle, log_length, nullptr, &buf[0]);
-            fprintf(stderr, "%s\n", buf.begin());
-        }
-        return (GLboolean)status == GL_TRUE;
-    }
+        for(const DrawBatch &batch : drawList->batches) {
+            const DrawListItem &first = drawList->items[batch.itemOffset];
+            Rectangle rect = first.clippingRect;
 
-    void Graphics::createShader() {
-        std::string vertexSource = R"(#version 330 core
-layout(location = 0) in vec2 aPosition;
-layout(location = 1) in vec2 aTexCoord;
-layout(location = 2) in vec4 aColor;
+            if(!rect.isZero())
+                rect = Rectangle(rect.x * scale.x + translation.x, rect.y * scale.y + translation.y, rect.width * scale.x, rect.height * scale.y);
 
-uniform mat4 uProjection;
-out vec2 oTexCoord;
-out vec4 oColor;
+            if(!replay.clippingRect.isZero())
+                rect = rect.isZero() ? replay.clippingRect : clipBounds(rect, replay.clippingRect);
 
-void main() {
-    gl_Position = uProjection * vec4(aPosition.x, aPosition.y, 0.0, 1.0);
-    oTexCoord = aTexCoord;
-    oColor = aColor;
-})";
+            if(!rect.isZero()) {
+                // Nothing of the batch is left inside the clipping rectangles
+                if(rect.width <= 0.0f || rect.height <= 0.0f)
+                    continue;
+                rect.y = viewport.height - rect.y - rect.height;
+            }
 
-        std::string fragmentSource = R"(#version 330 core
-uniform sampler2D uTexture;
-uniform float uTime;
-uniform int uIsFont;
+            applyItemState(first, rect, item.replay);
 
-in vec2 oTexCoord;
-in vec4 oColor;
-out vec4 FragColor;
+            stateCache.bindVertexArray(first.instanceCount > 0 ? drawList->instanceVAO : drawList->VAO);
 
-void main() {
-    if(uIsFont > 0) {
-        vec4 sample = texture(uTexture, oTexCoord);
-        if(sample.r == 0)
-            discard;
-        //FragColor = sample.r * oColor;
-        float d = sample.r;
-        float aaf = fwidth(d);
-        float alpha = smoothstep(0.5 - aaf, 0.5 + aaf, d);
-        FragColor = vec4(oColor.rgb, alpha) * oColor;
-    } else {
-        FragColor = texture(uTexture, oTexCoord) * oColor;
+            drawBatch(drawList->items.data(), batch, 0, QUAD_PATTERN_SIZE, drawList->instanceVBO);
+        }
     }
-})";
 
-        const GLchar* vertex_shader[1] = {
-            vertexSource.c_str()
-        };
+    // Recorded like a draw list, the list is kept by the target and rendered into it by the next newFrame
+    bool Graphics::beginRenderTarget(RenderTarget *target, const Vector2 &origin) {
+        if(target == nullptr || !target->isValid())
+            return false;
 
-        const GLchar* fragment_shader[1] = {
-            fragmentSource.c_str()
-        };
+        if(!beginDrawList(&target->drawList))
+            return false;
 
-        GLuint vert_handle = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vert_handle, 1, vertex_shader, nullptr);
-        glCompileShader(vert_handle);
-        checkShader(vert_handle, "vertex shader");
+        target->origin = origin;
+        recordingTarget = target;
+        return true;
+    }
 
-        GLuint frag_handle = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(frag_handle, 1, fragment_shader, nullptr);
-        glCompileShader(frag_handle);
-        checkShader(frag_handle, "fragment shader");
+    void Graphics::endRenderTarget() {
+        if(recordingTarget == nullptr) {
+            std::cerr << "Graphics::endRenderTarget called without a matching beginRenderTarget" << std::endl;
+            return;
+        }
 
-        shaderId = glCreateProgram();
-        glAttachShader(shaderId, vert_handle);
-        glAttachShader(shaderId, frag_handle);
-        glLinkProgram(shaderId);
-        checkProgram(shaderId, "shader program");
+        RenderTarget *target = recordingTarget;
+        recordingTarget = nullptr;
 
-        glDetachShader(shaderId, vert_handle);
-        glDetachShader(shaderId, frag_handle);
-        glDeleteShader(vert_handle);
-        glDeleteShader(frag_handle);
+        endDrawList();
 
-        uniforms[Uniform_Texture] = glGetUniformLocation(shaderId, "uTexture");
-        uniforms[Uniform_Projection] = glGetUniformLocation(shaderId, "uProjection");
-        uniforms[Uniform_IsFont] = glGetUniformLocation(shaderId, "uIsFont");
-        uniforms[Uniform_Time] = glGetUniformLocation(shaderId, "uTime");
-    }
+        // Recording a target twice in a frame only renders the last recording
+        for(size_t i = 0; i < targetCount; i++) {
+            if(targets[i] == target)
+                return;
+        }
 
-    void Graphics::createTexture() {
-        unsigned char textureData[16];
-        memset(textureData, 255, 16);
+        if(targets.size() <= targetCount)
+            targets.resize(targetCount + 1);
 
-        glGenTextures(1, &textureId);
-        glBindTexture(GL_TEXTURE_2D, textureId);
+        targets[targetCount++] = target;
+    }
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // The texture is flipped vertically, its first row is the bottom of the target
+    void Graphics::addRenderTarget(const RenderTarget *target, const Vector2 &position, const Vector2 &size, float opacity, const Rectangle &clippingRect) {
+        if(target == nullptr || !target->isValid())
+            return;
+
+        // Scaling every channel fades premultiplied colors
+        const Color color(opacity, opacity, opacity, opacity);
+
+        Vertex vertices[4] = {
+            { Vector2(position.x, position.y), Vector2(0, 1), color }, // top left
+            { Vector2(position.x, position.y + size.y), Vector2(0, 0), color }, // bottom left
+            { Vector2(position.x + size.x, position.y + size.y), Vector2(1, 0), color }, // bottom right
+            { Vector2(position.x + size.x, position.y), Vector2(1, 1), color }  // top right
+        };
+
+        DrawCommand command;
+        command.vertices = vertices;
+        command.indices = nullptr;
+        command.numVertices = 4;
+        command.numIndices = 6;
+        command.textureId = target->texture;
+        command.textureIsFont = false;
+        command.premultiplied = true;
+        command.shaderId = 0;
+        command.clippingRect = clippingRect;
+        command.userData = nullptr;
+
+        addVertices(&command);
+    }
+
+    // Replays the list of every target recorded this frame into its framebuffer, moved so the origin lands at (0, 0)
+    // Expects the frame state to be set up, the frame uniforms are left for the size of the last target
+    void Graphics::drawRenderTargets() {
+        const Viewport frameViewport = viewport;
+
+        GLint previousFramebuffer = 0;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+
+        renderingTarget = true;
+
+        for(size_t i = 0; i < targetCount; i++) {
+            RenderTarget *target = targets[i];
+
+            if(!target->isValid())
+                continue;
+
+            glBindFramebuffer(GL_FRAMEBUFFER, target->framebuffer);
+
+            viewport = { 0, 0, target->width, target->height };
+            glViewport(0, 0, target->width, target->height);
+            updateFrameUniforms();
+
+            stateCache.setScissorTest(false);
+            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            if(target->drawList.batches.size() == 0)
+                continue;
+
+            if(replays.size() <= replayCount)
+                replays.resize(replayCount + 1);
+
+            DrawListReplay &replay = replays[replayCount];
+            replay.drawList = &target->drawList;
+            replay.clippingRect = Rectangle(0, 0, 0, 0);
+
+            const float model[16] = {
+                1.0f,              0.0f,              0.0f, 0.0f,
+                0.0f,              1.0f,              0.0f, 0.0f,
+                0.0f,              0.0f,              1.0f, 0.0f,
+                -target->origin.x, -target->origin.y, 0.0f, 1.0f
+            };
+
+            memcpy(replay.model, model, sizeof(model));
+
+            DrawListItem item;
+            item.replay = replayCount++;
+
+            replayDrawList(item);
+        }
+
+        renderingTarget = false;
+
+        glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+
+        viewport = frameViewport;
+        glViewport(0, 0, viewport.width, viewport.height);
+        glClearColor(clearColor.r, clearColor.g, clearColor.b, clearColor.a);
+        stateCache.setScissorTest(false);
+    }
+
+    void Graphics::addPlotBuffer(PlotBuffer *plotBuffer, const Vector2 &position, const Vector2 &size, float thickness, const Color &color, float scaleMin, float scaleMax, const Rectangle &clippingRect) {
+        if(plotBuffer == nullptr || !plotBuffer->isValid())
+            return;
+
+        if(recordingList) {
+            std::cerr << "Graphics::addPlotBuffer can not be used while recording a draw list" << std::endl;
+            return;
+        }
+
+        const Rectangle clip = getEffectiveClip(clippingRect);
+
+        // Only the samples appended since the last draw are sent, the rest is already on the GPU
+        plotBuffer->upload();
+        numUploadedBytes += plotBuffer->getUploadedBytes();
+
+        if(plotBuffer->getCount() < 2)
+            return;
+
+        if(!clip.isZero() && (clip.width <= 0.0f || clip.height <= 0.0f))
+            return;
+
+        if(plots.size() <= plotCount)
+            plots.resize(plotCount + 1);
+
+        const float range = scaleMax - scaleMin;
+
+        PlotBufferDraw &plot = plots[plotCount];
+        plot.plotBuffer = plotBuffer;
+        plot.rectangle = Rectangle(position.x, position.y, size.x, size.y);
+        plot.scale = range != 0.0f ? 1.0f / range : 0.0f;
+        plot.offset = range != 0.0f ? -scaleMin / range : 0.0f;
+        plot.thickness = thickness;
+        plot.color = color;
+
+        checkItemBuffer(1);
+
+        const float halfThickness = thickness * 0.5f;
+
+        DrawListItem &item = items[itemCount];
+        item.shaderId = plotShaderId;
+        item.textureId = 0;
+        item.vertexOffset = 0;
+        item.vertexCount = 0;
+        item.indiceOffset = 0;
+        item.indiceCount = 0;
+        item.instanceOffset = 0;
+        item.instanceCount = 0;
+        item.indexSize = sizeof(uint16_t);
+        item.quads = false;
+        item.textureIsFont = false;
+        item.premultiplied = false;
+        item.clippingRect = clip;
+        item.userData = nullptr;
+        item.bounds = clipBounds(Rectangle(position.x - halfThickness, position.y - halfThickness, size.x + thickness, size.y + thickness), clip);
+        item.layer = layer;
+        item.replay = DrawListItem::NO_REPLAY;
+        item.plot = plotCount;
+
+        if(layer != 0)
+            layersUsed = true;
+
+        Rectangle &rect = item.clippingRect;
+
+        if(!rect.isZero()) {
+            rect.y = viewport.height - rect.y - rect.height;
+        }
+
+        itemCount++;
+        plotCount++;
+    }
+
+    // The line is generated from gl_VertexID, 6 vertices per pair of samples, so no vertex data is bound
+    void Graphics::drawPlotBuffer(const DrawListItem &item) {
+        const PlotBufferDraw &plot = plots[item.plot];
+        const PlotBuffer *plotBuffer = plot.plotBuffer;
+
+        setScissor(item.clippingRect);
+
+        setBlendFunc(false);
+
+        stateCache.useProgram(plotShaderId);
+        stateCache.bindVertexArray(VAO);
+
+        glBindTexture(GL_TEXTURE_BUFFER, plotBuffer->texture);
+
+        const Rectangle &r = plot.rectangle;
+        glUniform1i(plotUniforms[PlotUniform_Start], static_cast<GLint>(plotBuffer->getStart()));
+        glUniform1i(plotUniforms[PlotUniform_Capacity], static_cast<GLint>(plotBuffer->capacity));
+        glUniform4f(plotUniforms[PlotUniform_Rectangle], r.x, r.y, r.width, r.height);
+        glUniform2f(plotUniforms[PlotUniform_Scale], plot.scale, plot.offset);
+        glUniform1f(plotUniforms[PlotUniform_Thickness], plot.thickness);
+        glUniform4f(plotUniforms[PlotUniform_Color], plot.color.r, plot.color.g, plot.color.b, plot.color.a);
+
+        const int32_t vertexCount = static_cast<int32_t>((plotBuffer->count - 1) * 6);
+
+        DrawSubmission submission;
+        submission.kind = SubmissionKind_Arrays;
+        submission.indexSize = 0;
+        submission.counts = &vertexCount;
+        submission.offsets = nullptr;
+        submission.baseVertices = nullptr;
+        submission.drawCount = 1;
+        submission.instanceCount = 0;
+
+        backend->submit(submission);
+        numDrawCalls++;
+
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+
+    // Clipping rectangles are flipped, during a partial redraw nothing may be drawn outside of the damaged area
+    void Graphics::setScissor(const Rectangle &clippingRect) {
+        if(partialRedraw) {
+            const Rectangle rect = clippingRect.isZero() ? damageScissor : clipBounds(clippingRect, damageScissor);
+            stateCache.setScissorTest(true);
+            stateCache.setScissor(rect.x, rect.y, rect.width, rect.height);
+            return;
+        }
+
+        stateCache.setScissorTest(!clippingRect.isZero());
+        if(!clippingRect.isZero())
+            stateCache.setScissor(clippingRect.x, clippingRect.y, clippingRect.width, clippingRect.height);
+    }
+
+    static uint64_t mixHash(uint64_t hash, uint64_t value) {
+        return hash ^ (value + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2));
+    }
+
+    // Only has to tell frames apart, so it mixes 8 bytes at a time instead of being a good general purpose hash
+    static uint64_t hashBytes(const void *data, size_t size, uint64_t hash) {
+        const uint8_t *bytes = static_cast<const uint8_t*>(data);
+        size_t i = 0;
+
+        for(; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+            uint64_t word;
+            memcpy(&word, bytes + i, sizeof(uint64_t));
+            hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+            hash ^= hash >> 29;
+        }
+
+        if(i < size) {
+            uint64_t word = 0;
+            memcpy(&word, bytes + i, size - i);
+            hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+            hash ^= hash >> 29;
+        }
+
+        return mixHash(hash, size);
+    }
+
+    // Covers everything that decides what the item puts on screen, except for texture contents and custom uniforms
+    // Vertices and indices are not touched here, their hash is taken in addVertices from the memory of the caller
+    uint64_t Graphics::hashItem(const DrawListItem &item) const {
+        uint64_t hash = mixHash(item.shaderId, item.textureId);
+        hash = mixHash(hash, (item.textureIsFont ? 1 : 0) | (item.premultiplied ? 2 : 0) | (item.quads ? 4 : 0) | (static_cast<uint64_t>(item.indexSize) << 8));
+        hash = mixHash(hash, reinterpret_cast<uintptr_t>(item.userData));
+        hash = hashBytes(&item.clippingRect, sizeof(Rectangle), hash);
+        hash = hashBytes(&item.bounds, sizeof(Rectangle), hash);
+
+        if(item.replay != DrawListItem::NO_REPLAY) {
+            const DrawListReplay &replay = replays[item.replay];
+            hash = mixHash(hash, reinterpret_cast<uintptr_t>(replay.drawList));
+            hash = mixHash(hash, replay.drawList->revision);
+            hash = hashBytes(replay.model, sizeof(replay.model), hash);
+            hash = hashBytes(&replay.clippingRect, sizeof(Rectangle), hash);
+        } else if(item.plot != DrawListItem::NO_PLOT) {
+            const PlotBufferDraw &plot = plots[item.plot];
+            const float values[] = { plot.scale, plot.offset, plot.thickness, plot.color.r, plot.color.g, plot.color.b, plot.color.a };
+            hash = mixHash(hash, reinterpret_cast<uintptr_t>(plot.plotBuffer));
+            hash = mixHash(hash, plot.plotBuffer->revision);
+            hash = hashBytes(&plot.rectangle, sizeof(Rectangle), hash);
+            hash = hashBytes(values, sizeof(values), hash);
+        } else if(item.instanceCount > 0) {
+            hash = hashBytes(&instances[item.instanceOffset], item.instanceCount * sizeof(InstanceData), hash);
+        } else {
+            hash = mixHash(hash, item.geometryHash);
+        }
+
+        // A target rendered this frame has new content, no matter whether the quad that shows it moved
+        for(size_t i = 0; i < targetCount && item.textureId > 0; i++) {
+            if(targets[i]->texture == item.textureId)
+                hash = mixHash(hash, frameNumber);
+        }
+
+        return hash;
+    }
+
+    // Compares the items with those of the previous frame in drawing order. An item that differs damages both the area it
+    // covers now and the area the item at its position covered before, everything else looks exactly the same as last frame
+    // The damage is the whole viewport unless it is for a partial redraw. Returns false when nothing has to be drawn
+    bool Graphics::findDamage(Rectangle &damage, bool partial) {
+        const Rectangle screen(0, 0, viewport.width, viewport.height);
+
+        if(itemHashes.size() < itemCount)
+            itemHashes.resize(itemCount);
+
+        uint64_t frameHash = mixHash(0, itemCount);
+
+        for(size_t i = 0; i < itemCount; i++) {
+            itemHashes[i] = hashItem(items[i]);
+            frameHash = mixHash(frameHash, itemHashes[i]);
+        }
+
+        const size_t previousCount = previousHashes.size();
+        Rectangle area = pendingDamage;
+        bool damaged = !pendingDamage.isZero();
+
+        if(damageTracking == DamageTracking_Partial) {
+            for(size_t i = 0; i < std::max(itemCount, previousCount); i++) {
+                if(i < itemCount && i < previousCount && itemHashes[i] == previousHashes[i])
+                    continue;
+                if(i < itemCount) {
+                    area = damaged ? unite(area, items[i].bounds) : items[i].bounds;
+                    damaged = true;
+                }
+                if(i < previousCount) {
+                    area = damaged ? unite(area, previousBounds[i]) : previousBounds[i];
+                    damaged = true;
+                }
+            }
+        } else if(frameHash != previousFrameHash) {
+            area = screen;
+            damaged = true;
+        }
+
+        if(fullDamage || (damaged && partial && frameTargetStale)) {
+            area = screen;
+            damaged = true;
+        }
+
+        // Whole pixels, with a pixel of margin for antialiased edges
+        if(damaged) {
+            const float left = std::max(0.0f, std::floor(area.x) - 1.0f);
+            const float top = std::max(0.0f, std::floor(area.y) - 1.0f);
+            const float right = std::min(screen.width, std::ceil(area.x + area.width) + 1.0f);
+            const float bottom = std::min(screen.height, std::ceil(area.y + area.height) + 1.0f);
+            damaged = right > left && bottom > top;
+            damage = damaged ? Rectangle(left, top, right - left, bottom - top) : Rectangle(0, 0, 0, 0);
+        } else {
+            damage = Rectangle(0, 0, 0, 0);
+        }
+
+        if(!partial)
+            damage = screen;
+
+        previousHashes.assign(itemHashes.begin(), itemHashes.begin() + itemCount);
+        previousBounds.resize(itemCount);
+        for(size_t i = 0; i < itemCount; i++)
+            previousBounds[i] = items[i].bounds;
+
+        previousFrameHash = frameHash;
+        pendingDamage = Rectangle(0, 0, 0, 0);
+        fullDamage = false;
+
+        // Targets recorded this frame have to be rendered even when nothing on screen shows them
+        return damaged || targetCount > 0;
+    }
+
+    // Keeps the frame target at the size of the viewport, recreating it loses the previous frame
+    bool Graphics::prepareFrameTarget() {
+        if(viewport.width == 0 || viewport.height == 0)
+            return false;
+
+        if(frameTarget == nullptr)
+            frameTarget = new RenderTarget();
+
+        if(frameTarget->isValid() && frameTarget->getWidth() == viewport.width && frameTarget->getHeight() == viewport.height)
+            return true;
+
+        frameTargetStale = true;
+        return frameTarget->create(viewport.width, viewport.height);
+    }
+
+    // Items outside of the damaged area would only be thrown away by the scissor test
+    void Graphics::cullItems(const Rectangle &damage) {
+        size_t count = 0;
+
+        for(size_t i = 0; i < itemCount; i++) {
+            if(!overlaps(items[i].bounds, damage))
+                continue;
+            if(count != i)
+                items[count] = items[i];
+            count++;
+        }
+
+        itemCount = count;
+    }
+
+    void Graphics::setDamageTracking(DamageTracking mode) {
+        damageTracking = mode;
+        previousHashes.clear();
+        previousBounds.clear();
+        fullDamage = true;
+        frameTargetStale = true;
+
+        if(mode != DamageTracking_Partial && frameTarget) {
+            frameTarget->destroy();
+            delete frameTarget;
+            frameTarget = nullptr;
+        }
+    }
+
+    void Graphics::addDamage(const Rectangle &rect) {
+        pendingDamage = pendingDamage.isZero() ? rect : unite(pendingDamage, rect);
+    }
+
+    void Graphics::invalidate() {
+        fullDamage = true;
+    }
+
+    // Appends the recorded commands in the order of the array and then in recording order within each buffer,
+    // so the result does not depend on which worker finished first
+    void Graphics::addCommandBuffers(const CommandBuffer *commandBuffers, size_t count) {
+        if(commandBuffers == nullptr || count == 0)
+            return;
+
+        size_t numVertices = 0;
+        size_t numIndexBytes = 0;
+        size_t numCommands = 0;
+
+        for(size_t i = 0; i < count; i++) {
+            numVertices += commandBuffers[i].vertices.size();
+            // Worst case is 32 bit indices with padding in front of every command
+            numIndexBytes += (commandBuffers[i].indices.size() + commandBuffers[i].commands.size()) * sizeof(uint32_t);
+            numCommands += commandBuffers[i].commands.size();
+        }
+
+        // Grow once up front instead of while merging
+        checkVertexBuffer(numVertices);
+        checkIndexBuffer(numIndexBytes);
+        checkItemBuffer(numCommands);
+
+        const int32_t currentLayer = layer;
+
+        for(size_t i = 0; i < count; i++) {
+            const CommandBuffer &commandBuffer = commandBuffers[i];
+
+            for(const RecordedCommand &recorded : commandBuffer.commands) {
+                layer = recorded.layer;
+
+                if(recorded.numInstances > 0) {
+                    for(size_t j = 0; j < recorded.numInstances; j++)
+                        addInstance(commandBuffer.instances[recorded.instanceOffset + j], textureId, recorded.clippingRect, recorded.userData);
+                    continue;
+                }
+
+                const bool quads = recorded.numIndices == 0;
+
+                // addVertices only reads from the command
+                DrawCommand command;
+                command.vertices = const_cast<Vertex*>(&commandBuffer.vertices[recorded.vertexOffset]);
+                command.numVertices = recorded.numVertices;
+                command.indices = quads ? nullptr : const_cast<uint32_t*>(&commandBuffer.indices[recorded.indexOffset]);
+                command.numIndices = quads ? (recorded.numVertices / 4) * 6 : recorded.numIndices;
+                command.textureId = recorded.textureId == 0 ? textureId : recorded.textureId;
+                command.textureIsFont = recorded.textureIsFont;
+                command.shaderId = recorded.shaderId;
+                command.clippingRect = recorded.clippingRect;
+                command.userData = recorded.userData;
+
+                addVertices(&command);
+            }
+        }
+
+        layer = currentLayer;
+    }
+
+    void Graphics::setViewport(uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+        if(width != viewport.width || height != viewport.height)
+            fullDamage = true;
+
+        glViewport(0, 0, width, height);
+        viewport.x = x;
+        viewport.y = y;
+        viewport.width = width;
+        viewport.height = height;
+    }
+
+    void Graphics::setClearColor(const Color &color) {
+        if(color.r != clearColor.r || color.g != clearColor.g || color.b != clearColor.b || color.a != clearColor.a)
+            fullDamage = true;
+
+        this->clearColor = color;
+    }
+
+    void Graphics::setBufferUploadMode(BufferUploadMode mode) {
+        requestedUploadMode = mode;
+
+        if(mode == uploadMode)
+            return;
+
+        if(VAO == 0) {
+            uploadMode = mode;
+            return;
+        }
+
+        // Geometry in the ring buffer can not be read back for the staging vectors, so the switch waits until it is submitted
+        if(vertexCount > 0 || indexByteCount > 0)
+            return;
+
+        reallocateBuffers(mode, vertexCapacity, indexCapacity);
+    }
+
+    void Graphics::setInstancingEnabled(bool enabled) {
+        instancingEnabled = enabled;
+    }
+
+    void Graphics::setLayer(int32_t layer) {
+        this->layer = layer;
+    }
+
+    void Graphics::pushClip(const Rectangle &rect) {
+        clipStack.push_back(clipStack.empty() ? rect : clipStack.back().intersect(rect));
+    }
+
+    void Graphics::popClip() {
+        if(clipStack.empty()) {
+            std::cerr << "Graphics::popClip called without a matching pushClip" << std::endl;
+            return;
+        }
+        clipStack.pop_back();
+    }
+
+    Rectangle Graphics::getClip() const {
+        return clipStack.empty() ? Rectangle(0, 0, 0, 0) : clipStack.back();
+    }
+
+    void Graphics::setVertexFormat(VertexFormat format) {
+        requestedVertexFormat = format;
+
+        if(format == vertexFormat)
+            return;
+
+        // Geometry that was already added this frame is stored in the current format, so the switch waits until it is submitted
+        if(vertexCount > 0)
+            return;
+
+        vertexFormat = format;
+        vertexStride = vertexFormat == VertexFormat_Compact ? sizeof(CompactVertex) : sizeof(Vertex);
+
+        if(VAO > 0)
+            reallocateBuffers(uploadMode, vertexCapacity, indexCapacity);
+    }
+
+    void Graphics::checkVertexBuffer(size_t numRequiredVertices) {
+        size_t verticesNeeded = vertexCount + numRequiredVertices;
+        
+        if(verticesNeeded > vertexCapacity) {
+            size_t newSize = vertexCapacity * 2;
+            while(newSize < verticesNeeded) {
+                newSize *= 2;
+            }
+            reallocateBuffers(uploadMode, newSize, indexCapacity);
+        }
+    }
+
+    void Graphics::checkIndexBuffer(size_t numRequiredBytes) {
+        size_t bytesNeeded = indexByteCount + numRequiredBytes;
+        
+        if(bytesNeeded > indexCapacity) {
+            size_t newSize = indexCapacity * 2;
+            while(newSize < bytesNeeded) {
+                newSize *= 2;
+            }
+            reallocateBuffers(uploadMode, vertexCapacity, newSize);
+        }
+    }
+
+    void Graphics::checkItemBuffer(size_t numRequiredItems) {
+        size_t itemsNeeded = itemCount + numRequiredItems;
+
+        if(itemsNeeded > items.size()) {
+            size_t newSize = items.size() * 2;
+            while(newSize < itemsNeeded) {
+                newSize *= 2;
+            }
+            items.resize(newSize);
+        }
+    }
+
+    void Graphics::checkInstanceBuffer(size_t numRequiredInstances) {
+        size_t instancesNeeded = instanceCount + numRequiredInstances;
+
+        if(instancesNeeded > instances.size()) {
+            size_t newSize = instances.size() * 2;
+            while(newSize < instancesNeeded) {
+                newSize *= 2;
+            }
+            instances.resize(newSize);
+        }
+    }
+
+    void Graphics::checkTemporaryVertexBuffer(size_t numRequiredVertices) {
+        if(vertexBufferTemp.size() < numRequiredVertices) {
+            size_t newSize = vertexBufferTemp.size() * 2;
+            while(newSize < numRequiredVertices) {
+                newSize *= 2;
+            }                
+            vertexBufferTemp.resize(newSize);
+        }
+    }
+
+    void Graphics::checkTemporaryIndexBuffer(size_t numRequiredIndices) {
+        if(indexBufferTemp.size() < (numRequiredIndices)) {
+            size_t newSize = indexBufferTemp.size() * 2;
+            while(newSize < numRequiredIndices) {
+                newSize *= 2;
+            }
+            indexBufferTemp.resize(newSize);
+        }
+    }
+
+    static Rectangle clipBounds(const Rectangle &bounds, const Rectangle &clippingRect) {
+        if(clippingRect.isZero())
+            return bounds;
+        float x = std::max(bounds.x, clippingRect.x);
+        float y = std::max(bounds.y, clippingRect.y);
+        float right = std::min(bounds.x + bounds.width, clippingRect.x + clippingRect.width);
+        float bottom = std::min(bounds.y + bounds.height, clippingRect.y + clippingRect.height);
+        return Rectangle(x, y, std::max(0.0f, right - x), std::max(0.0f, bottom - y));
+    }
+
+    void Graphics::addVertices(const DrawCommand *command) {
+        const uint32_t shaderId = command->shaderId == 0 ? this->shaderId : command->shaderId;
+        Rectangle clippingRect = getEffectiveClip(command->clippingRect);
+
+        // Nothing is left of a clipping rectangle without area
+        if(!clippingRect.isZero() && (clippingRect.width <= 0.0f || clippingRect.height <= 0.0f))
+            return;
+
+        Rectangle bounds(-1e30f, -1e30f, 2e30f, 2e30f);
+
+        // Custom shaders may move vertices around, so only geometry of the default shader has known bounds
+        if(shaderId == this->shaderId && command->numVertices > 0) {
+            Vector2 min = command->vertices[0].position;
+            Vector2 max = min;
+            for(size_t i = 1; i < command->numVertices; i++) {
+                const Vector2 &p = command->vertices[i].position;
+                min.x = std::min(min.x, p.x);
+                min.y = std::min(min.y, p.y);
+                max.x = std::max(max.x, p.x);
+                max.y = std::max(max.y, p.y);
+            }
+            bounds = Rectangle(min.x, min.y, max.x - min.x, max.y - min.y);
+        }
+
+        DrawCommand clippedCommand;
+
+        // Geometry that is fully inside or clipped on the CPU no longer needs the scissor, so it batches with unclipped items
+        if(!clippingRect.isZero() && shaderId == this->shaderId && command->numVertices > 0) {
+            const Rectangle visible = clipBounds(bounds, clippingRect);
+
+            if(visible.width <= 0.0f || visible.height <= 0.0f)
+                return;
+
+            if(visible.width == bounds.width && visible.height == bounds.height) {
+                clippingRect = Rectangle(0, 0, 0, 0);
+            } else if(command->indices == nullptr && clipQuads(command, clippingRect, clippedCommand)) {
+                if(clippedCommand.numVertices == 0)
+                    return;
+                command = &clippedCommand;
+                bounds = visible;
+                clippingRect = Rectangle(0, 0, 0, 0);
+            }
+        }
+
+        // Without indices the vertices are a list of quads, drawn with the static index pattern
+        const bool quads = command->indices == nullptr;
+        const uint8_t indexSize = (quads || command->numVertices <= 65536) ? sizeof(uint16_t) : sizeof(uint32_t);
+        size_t numIndexBytes = 0;
+
+        if(!quads) {
+            // Offsets of an index type must be aligned to its size
+            indexByteCount = (indexByteCount + indexSize - 1) & ~static_cast<size_t>(indexSize - 1);
+            numIndexBytes = command->numIndices * indexSize;
+        }
+
+        checkVertexBuffer(command->numVertices);
+        checkIndexBuffer(numIndexBytes);
+        checkItemBuffer(1);
+
+        // Recorded geometry is removed from the frame again, so it goes into the staging vectors instead of the ring buffer
+        uint8_t *vertexDestination = recordingList ? vertices.data() + (vertexCount * vertexStride) : vertexData + ((vertexCount - mappedVertexStart) * vertexStride);
+        uint8_t *indexDestination = recordingList ? indices.data() + indexByteCount : indexData + (indexByteCount - mappedIndexStart);
+
+        if(vertexFormat == VertexFormat_Compact)
+            packVertices(command->vertices, command->numVertices, reinterpret_cast<CompactVertex*>(vertexDestination));
+        else
+            memcpy(vertexDestination, &command->vertices[0], command->numVertices * sizeof(Vertex));
+
+        // Indices stay relative to the first vertex of the command, the base vertex is applied when drawing
+        if(indexSize == sizeof(uint16_t)) {
+            uint16_t *dst = reinterpret_cast<uint16_t*>(indexDestination);
+            for(size_t i = 0; i < command->numIndices && !quads; i++) {
+                dst[i] = static_cast<uint16_t>(command->indices[i]);
+            }
+        } else {
+            memcpy(indexDestination, command->indices, numIndexBytes);
+        }
+
+        items[itemCount].vertexCount = command->numVertices;
+        items[itemCount].indiceCount = command->numIndices;
+        items[itemCount].vertexOffset = vertexCount;
+        items[itemCount].indiceOffset = indexByteCount;
+        items[itemCount].instanceOffset = 0;
+        items[itemCount].instanceCount = 0;
+        items[itemCount].indexSize = indexSize;
+        items[itemCount].quads = quads;
+        items[itemCount].shaderId = shaderId;
+        items[itemCount].textureId = command->textureId;
+        items[itemCount].textureIsFont = command->textureIsFont;
+        items[itemCount].premultiplied = command->premultiplied;
+        items[itemCount].clippingRect = clippingRect;
+        // User data is only handed to the uniform callback of custom shaders, so it must not prevent batching otherwise
+        items[itemCount].userData = shaderId == this->shaderId ? nullptr : command->userData;
+        items[itemCount].bounds = clipBounds(bounds, clippingRect);
+        items[itemCount].layer = layer;
+        items[itemCount].replay = DrawListItem::NO_REPLAY;
+        items[itemCount].plot = DrawListItem::NO_PLOT;
+        items[itemCount].geometryHash = 0;
+
+        // Hashed from the memory of the caller while it is still in the cache, the buffers of the frame may be a write only mapping
+        if(damageTracking != DamageTracking_None) {
+            uint64_t &hash = items[itemCount].geometryHash;
+            hash = hashBytes(command->vertices, command->numVertices * sizeof(Vertex), 0);
+            if(!quads)
+                hash = hashBytes(command->indices, command->numIndices * sizeof(uint32_t), hash);
+        }
+
+        if(layer != 0)
+            layersUsed = true;
+
+        Rectangle &rect = items[itemCount].clippingRect;
+
+        if(!rect.isZero()) {
+            rect.y = viewport.height - rect.y - rect.height;
+        }
+
+        itemCount++;
+        vertexCount += command->numVertices;
+        indexByteCount += numIndexBytes;
+    }
+
+    // The clip of the stack applies on top of the clipping rectangle of a call
+    Rectangle Graphics::getEffectiveClip(const Rectangle &clippingRect) const {
+        if(clipStack.empty())
+            return clippingRect;
+        if(clippingRect.isZero())
+            return clipStack.back();
+        return clipStack.back().intersect(clippingRect);
+    }
+
+    // Cuts axis aligned quads down to the clipping rectangle, the attributes of the moved corners are interpolated
+    // Returns false when any quad is rotated or skewed, those are left to the scissor test
+    bool Graphics::clipQuads(const DrawCommand *command, const Rectangle &clippingRect, DrawCommand &clipped) {
+        const size_t numQuads = command->numVertices / 4;
+
+        if(clipBufferTemp.size() < numQuads * 4)
+            clipBufferTemp.resize(numQuads * 4);
+
+        const float clipLeft = clippingRect.x;
+        const float clipTop = clippingRect.y;
+        const float clipRight = clippingRect.x + clippingRect.width;
+        const float clipBottom = clippingRect.y + clippingRect.height;
+
+        auto lerp = [] (float a, float b, float t) {
+            return a + (b - a) * t;
+        };
+
+        size_t count = 0;
+
+        for(size_t q = 0; q < numQuads; q++) {
+            const Vertex *quad = &command->vertices[q * 4];
+
+            float left = quad[0].position.x;
+            float top = quad[0].position.y;
+            float right = left;
+            float bottom = top;
+
+            for(size_t v = 1; v < 4; v++) {
+                left = std::min(left, quad[v].position.x);
+                top = std::min(top, quad[v].position.y);
+                right = std::max(right, quad[v].position.x);
+                bottom = std::max(bottom, quad[v].position.y);
+            }
+
+            // Quads without area are invisible, the same goes for quads outside of the rectangle
+            if(left == right || top == bottom)
+                continue;
+            if(right <= clipLeft || left >= clipRight || bottom <= clipTop || top >= clipBottom)
+                continue;
+
+            // Every vertex has to sit on a different corner of the bounding box
+            const Vertex *corners[4] = { nullptr, nullptr, nullptr, nullptr }; // top left, top right, bottom left, bottom right
+
+            for(size_t v = 0; v < 4; v++) {
+                const Vector2 &p = quad[v].position;
+                if((p.x != left && p.x != right) || (p.y != top && p.y != bottom))
+                    return false;
+                const size_t corner = (p.x == right ? 1 : 0) + (p.y == bottom ? 2 : 0);
+                if(corners[corner] != nullptr)
+                    return false;
+                corners[corner] = &quad[v];
+            }
+
+            const float newLeft = std::max(left, clipLeft);
+            const float newTop = std::max(top, clipTop);
+            const float newRight = std::min(right, clipRight);
+            const float newBottom = std::min(bottom, clipBottom);
+
+            Vertex *destination = &clipBufferTemp[count * 4];
+
+            for(size_t v = 0; v < 4; v++) {
+                const Vertex &source = quad[v];
+                const float x = source.position.x == right ? newRight : newLeft;
+                const float y = source.position.y == bottom ? newBottom : newTop;
+                const float tx = (x - left) / (right - left);
+                const float ty = (y - top) / (bottom - top);
+
+                destination[v] = source;
+                destination[v].position = Vector2(x, y);
+
+                const Vertex &a = *corners[0];
+                const Vertex &b = *corners[1];
+                const Vertex &c = *corners[2];
+                const Vertex &d = *corners[3];
+
+                destination[v].uv = Vector2(
+                    lerp(lerp(a.uv.x, b.uv.x, tx), lerp(c.uv.x, d.uv.x, tx), ty),
+                    lerp(lerp(a.uv.y, b.uv.y, tx), lerp(c.uv.y, d.uv.y, tx), ty));
+                destination[v].color.r = lerp(lerp(a.color.r, b.color.r, tx), lerp(c.color.r, d.color.r, tx), ty);
+                destination[v].color.g = lerp(lerp(a.color.g, b.color.g, tx), lerp(c.color.g, d.color.g, tx), ty);
+                destination[v].color.b = lerp(lerp(a.color.b, b.color.b, tx), lerp(c.color.b, d.color.b, tx), ty);
+                destination[v].color.a = lerp(lerp(a.color.a, b.color.a, tx), lerp(c.color.a, d.color.a, tx), ty);
+            }
+
+            count++;
+        }
+
+        clipped = *command;
+        clipped.vertices = clipBufferTemp.data();
+        clipped.numVertices = count * 4;
+        clipped.numIndices = count * 6;
+        return true;
+    }
+
+    // Draws an SDF shape as a single instance, shapes go through the instanced pipeline whether or not instancing is enabled for other primitives
+    void Graphics::addShape(const Vector2 &position, const Vector2 &size, float rotationDegrees, const Color &color, const Vector2 &shape, const Rectangle &clippingRect, void *userData) {
+        if(size.x <= 0.0f || size.y <= 0.0f)
+            return;
+
+        addInstance(InstanceData::createShape(position, size, rotationDegrees, color, shape), textureId, clippingRect, userData);
+    }
+
+    void Graphics::addInstance(const InstanceData &instance, uint32_t textureId, const Rectangle &clippingRect, void *userData) {
+        Rectangle bounds(instance.position.x, instance.position.y, instance.size.x, instance.size.y);
+
+        if(instance.rotation != 0.0f) {
+            // Any rotation stays within the circle around the center that passes through the corners
+            float radius = 0.5f * std::sqrt(instance.size.x * instance.size.x + instance.size.y * instance.size.y);
+            Vector2 center(instance.position.x + instance.size.x * 0.5f, instance.position.y + instance.size.y * 0.5f);
+            bounds = Rectangle(center.x - radius, center.y - radius, radius * 2.0f, radius * 2.0f);
+        }
+
+        *addInstances(1, textureId, bounds, clippingRect) = instance;
+    }
+
+    // Reserves a run of instances that share one item, the caller has to fill all of them
+    // The bounds have to cover every instance of the run
+    InstanceData *Graphics::addInstances(size_t count, uint32_t textureId, const Rectangle &bounds, const Rectangle &clippingRect) {
+        Rectangle rect = getEffectiveClip(clippingRect);
+
+        // The caller still writes the run, it goes to scratch memory that is never drawn
+        if(!rect.isZero() && !overlaps(bounds, rect)) {
+            if(culledInstancesTemp.size() < count)
+                culledInstancesTemp.resize(count);
+            return culledInstancesTemp.data();
+        }
+
+        checkInstanceBuffer(count);
+
+        InstanceData *destination = &instances[instanceCount];
+        const Rectangle clippedBounds = clipBounds(bounds, rect);
+
+        // Instances that lie fully inside do not need the scissor, which lets them join unclipped runs
+        if(!rect.isZero() && clippedBounds.width == bounds.width && clippedBounds.height == bounds.height)
+            rect = Rectangle(0, 0, 0, 0);
+
+        if(!rect.isZero()) {
+            rect.y = viewport.height - rect.y - rect.height;
+        }
+
+        // Extend the previous item when possible, so a run of instances only costs one item
+        // Items from before the start of a recording belong to the frame and are left alone
+        if(itemCount > recordItemOffset) {
+            DrawListItem &last = items[itemCount - 1];
+            const Rectangle &lastRect = last.clippingRect;
+            if(last.instanceCount > 0 && last.textureId == textureId && last.layer == layer &&
+               last.instanceOffset + last.instanceCount == instanceCount &&
+               lastRect.x == rect.x && lastRect.y == rect.y && lastRect.width == rect.width && lastRect.height == rect.height) {
+                last.bounds = unite(last.bounds, clippedBounds);
+                last.instanceCount += count;
+                instanceCount += count;
+                return destination;
+            }
+        }
+
+        checkItemBuffer(1);
+
+        DrawListItem &item = items[itemCount];
+        item.shaderId = instanceShaderId;
+        item.textureId = textureId;
+        item.vertexOffset = 0;
+        item.vertexCount = 0;
+        item.indiceOffset = 0;
+        item.indiceCount = 0;
+        item.instanceOffset = instanceCount;
+        item.instanceCount = count;
+        item.textureIsFont = false;
+        item.premultiplied = false;
+        item.clippingRect = rect;
+        item.userData = nullptr;
+        item.bounds = clippedBounds;
+        item.layer = layer;
+        item.replay = DrawListItem::NO_REPLAY;
+        item.plot = DrawListItem::NO_PLOT;
+
+        if(layer != 0)
+            layersUsed = true;
+
+        itemCount++;
+        instanceCount += count;
+
+        return destination;
+    }
+
+    // 16 bits keep texel accuracy on textures up to 65536 pixels, unlike half floats which lose it above 2048
+    static uint16_t floatToUnorm16(float value) {
+        if(value <= 0.0f)
+            return 0;
+        if(value >= 1.0f)
+            return 65535;
+        return static_cast<uint16_t>(value * 65535.0f + 0.5f);
+    }
+
+    static uint8_t floatToUnorm8(float value) {
+        if(value <= 0.0f)
+            return 0;
+        if(value >= 1.0f)
+            return 255;
+        return static_cast<uint8_t>(value * 255.0f + 0.5f);
+    }
+
+    InstanceData InstanceData::createShape(const Vector2 &position, const Vector2 &size, float rotationDegrees, const Color &color, const Vector2 &shape) {
+        const float padding = 1.0f;
+        const Vector2 extent(1.0f + (padding * 2.0f) / size.x, 1.0f + (padding * 2.0f) / size.y);
+
+        InstanceData instance;
+        instance.position = Vector2(position.x - padding, position.y - padding);
+        instance.size = Vector2(size.x + (padding * 2.0f), size.y + (padding * 2.0f));
+        instance.uv0 = Vector2(-extent.x, -extent.y);
+        instance.uv1 = extent;
+        setInstanceColor(instance, color);
+        instance.rotation = rotationDegrees * (M_PI / 180.0f);
+        instance.kind = InstanceKind_Shape;
+        instance.shape = shape;
+        return instance;
+    }
+
+    static void setInstanceColor(InstanceData &instance, const Color &color) {
+        instance.color[0] = floatToUnorm8(color.r);
+        instance.color[1] = floatToUnorm8(color.g);
+        instance.color[2] = floatToUnorm8(color.b);
+        instance.color[3] = floatToUnorm8(color.a);
+    }
+
+    void Graphics::packVertices(const Vertex *source, size_t numVertices, CompactVertex *destination) {
+        for(size_t i = 0; i < numVertices; i++) {
+            const Vertex &v = source[i];
+            CompactVertex &c = destination[i];
+            c.position = v.position;
+            c.uv[0] = floatToUnorm16(v.uv.x);
+            c.uv[1] = floatToUnorm16(v.uv.y);
+            c.color[0] = floatToUnorm8(v.color.r);
+            c.color[1] = floatToUnorm8(v.color.g);
+            c.color[2] = floatToUnorm8(v.color.b);
+            c.color[3] = floatToUnorm8(v.color.a);
+        }
+    }
+
+    void Graphics::createBuffers() {
+        constexpr size_t size = 2 << 15;
+        items.resize(size);
+        vertexBufferTemp.resize(size);
+        indexBufferTemp.resize(size);
+
+        glGenVertexArrays(1, &VAO);
+
+        std::vector<uint16_t> quadPattern(MAX_QUADS_PER_DRAW * 6);
+        writeQuadPattern(quadPattern.data(), MAX_QUADS_PER_DRAW);
+
+        quadPatternBuffer = backend->createBuffer();
+        backend->allocateBuffer(quadPatternBuffer, QUAD_PATTERN_SIZE, quadPattern.data(), BufferUsage_Static);
+
+        reallocateBuffers(uploadMode, size, size * sizeof(uint32_t));
+    }
+
+    // Writes the indices of MAX_QUADS_PER_DRAW quads, every quad is drawn as two triangles sharing its first vertex
+    static void writeQuadPattern(uint16_t *pattern, size_t numQuads) {
+        for(size_t i = 0; i < numQuads; i++) {
+            const uint16_t vertex = static_cast<uint16_t>(i * 4);
+            pattern[i*6+0] = vertex + 0;
+            pattern[i*6+1] = vertex + 1;
+            pattern[i*6+2] = vertex + 2;
+            pattern[i*6+3] = vertex + 0;
+            pattern[i*6+4] = vertex + 2;
+            pattern[i*6+5] = vertex + 3;
+        }
+    }
+
+    // (Re)creates the vertex and index buffers with the given capacity, the index capacity is in bytes
+    // The element buffer starts with the static quad pattern, followed by the indices of the frame (or of each ring region)
+    // Any geometry that has been added during the current frame is carried over to the new storage. The staging vectors keep
+    // theirs when resized, the ring buffer is write only so its region is copied on the GPU, into the first region of the new one
+    // A draw list that is being recorded lives in the staging vectors in either mode
+    void Graphics::reallocateBuffers(BufferUploadMode mode, size_t numVertices, size_t numIndexBytes) {
+        numBufferReallocations++;
+
+        const bool carryRegion = uploadMode == BufferUploadMode_RingBuffer && mode == BufferUploadMode_RingBuffer && VBO > 0;
+        const size_t carriedVertices = carryRegion ? (recordingList ? recordVertexOffset : vertexCount) : 0;
+        const size_t carriedIndexBytes = carryRegion ? (recordingList ? recordIndexOffset : indexByteCount) : 0;
+        const size_t carriedVertexOffset = ringRegion * vertexCapacity * vertexStride;
+        const size_t carriedIndexOffset = QUAD_PATTERN_SIZE + (ringRegion * indexCapacity);
+        uint32_t previousVBO = 0;
+        uint32_t previousEBO = 0;
+
+        if(carriedVertices > 0 || carriedIndexBytes > 0) {
+            // The previous buffers stay alive until their region has been copied
+            unmapRingBuffer();
+            previousVBO = VBO;
+            previousEBO = EBO;
+            VBO = 0;
+            EBO = 0;
+        }
+
+        releaseBuffers();
+
+        uploadMode = mode;
+        vertexCapacity = numVertices;
+        indexCapacity = numIndexBytes;
+
+        VBO = backend->createBuffer();
+        EBO = backend->createBuffer();
+
+        stateCache.bindVertexArray(VAO);
+        stateCache.bindBuffer(GL_ARRAY_BUFFER, VBO);
+        stateCache.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+        vertices.resize(vertexCapacity * vertexStride);
+        indices.resize(indexCapacity);
+
+        if(uploadMode == BufferUploadMode_SubData) {
+            vertexData = vertices.data();
+            indexData = indices.data();
+
+            backend->allocateBuffer(VBO, vertexCapacity * vertexStride, nullptr, BufferUsage_Dynamic);
+            backend->allocateBuffer(EBO, QUAD_PATTERN_SIZE + indexCapacity, nullptr, BufferUsage_Dynamic);
+        } else {
+            const size_t vertexBufferSize = RING_BUFFER_REGIONS * vertexCapacity * vertexStride;
+            const size_t indexBufferSize = QUAD_PATTERN_SIZE + (RING_BUFFER_REGIONS * indexCapacity);
+
+            persistentMapping = backend->supportsPersistentMapping();
+            ringRegion = 0;
+
+            if(persistentMapping) {
+                backend->allocatePersistentBuffer(VBO, vertexBufferSize);
+                backend->allocatePersistentBuffer(EBO, indexBufferSize);
+                mappedVertices = static_cast<uint8_t*>(backend->mapBuffer(VBO, 0, vertexBufferSize, MapMode_Persistent));
+                mappedIndices = static_cast<uint8_t*>(backend->mapBuffer(EBO, 0, indexBufferSize, MapMode_Persistent));
+            } else {
+                backend->allocateBuffer(VBO, vertexBufferSize, nullptr, BufferUsage_Stream);
+                backend->allocateBuffer(EBO, indexBufferSize, nullptr, BufferUsage_Stream);
+            }
+        }
+
+        // The ring buffer is not mapped yet, or only persistently, so it can be the destination of a copy
+        backend->copyBuffer(quadPatternBuffer, EBO, 0, 0, QUAD_PATTERN_SIZE);
+
+        setVertexAttributes(vertexFormat);
+
+        stateCache.bindVertexArray(0);
+        stateCache.bindBuffer(GL_ARRAY_BUFFER, 0);
+        stateCache.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+        if(previousVBO > 0) {
+            if(carriedVertices > 0)
+                backend->copyBuffer(previousVBO, VBO, carriedVertexOffset, 0, carriedVertices * vertexStride);
+            if(carriedIndexBytes > 0)
+                backend->copyBuffer(previousEBO, EBO, carriedIndexOffset, QUAD_PATTERN_SIZE, carriedIndexBytes);
+            backend->destroyBuffer(previousVBO);
+            backend->destroyBuffer(previousEBO);
+        }
+
+        if(uploadMode == BufferUploadMode_RingBuffer) {
+            // Geometry of the current frame that failed to map can not be recovered, it only ever existed in the old mapping
+            if(!mapRingRegion(carriedVertices, carriedIndexBytes)) {
+                std::cerr << "Failed to map ring buffer, falling back to BufferUploadMode_SubData" << std::endl;
+                reallocateBuffers(BufferUploadMode_SubData, numVertices, numIndexBytes);
+            }
+        }
+    }
+
+    // Expects the VAO and the vertex buffer to be bound
+    void Graphics::setVertexAttributes(VertexFormat format) {
+        if(format == VertexFormat_Compact) {
+            // The normalized RGBA8 color still arrives as a vec4 in [0, 1], so shaders work with either format
+            glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(CompactVertex), (GLvoid*)offsetof(CompactVertex, position));
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(CompactVertex), (GLvoid*)offsetof(CompactVertex, uv));
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(CompactVertex), (GLvoid*)offsetof(CompactVertex, color));
+            glEnableVertexAttribArray(2);
+        } else {
+            glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid*)offsetof(Vertex, position));
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid*)offsetof(Vertex, uv));
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid*)offsetof(Vertex, color));
+            glEnableVertexAttribArray(2);
+        }
+    }
+
+    void Graphics::releaseBuffers() {
+        if(uploadMode == BufferUploadMode_RingBuffer && VBO > 0)
+            unmapRingBuffer();
+
+        mappedVertices = nullptr;
+        mappedIndices = nullptr;
+        vertexData = nullptr;
+        indexData = nullptr;
+        mappedVertexStart = 0;
+        mappedIndexStart = 0;
+
+        if(VBO > 0) {
+            backend->destroyBuffer(VBO);
+            VBO = 0;
+        }
+
+        if(EBO > 0) {
+            backend->destroyBuffer(EBO);
+            EBO = 0;
+        }
+
+        // Deleting bound buffers resets their bindings, and their names may be reused
+        stateCache.invalidate();
+    }
+
+    // Unmaps the ring buffer and forgets the fences of its regions, the buffers themselves are left alone
+    void Graphics::unmapRingBuffer() {
+        if(persistentMapping) {
+            backend->unmapBuffer(VBO);
+            backend->unmapBuffer(EBO);
+        } else {
+            unmapRingRegion();
+        }
+
+        for(size_t i = 0; i < RING_BUFFER_REGIONS; i++) {
+            if(ringFences[i]) {
+                glDeleteSync(static_cast<GLsync>(ringFences[i]));
+                ringFences[i] = nullptr;
+            }
+        }
+
+        mappedVertices = nullptr;
+        mappedIndices = nullptr;
+        vertexData = nullptr;
+        indexData = nullptr;
+    }
+
+    // Makes the current ring region writable from the given vertex and index byte on, waiting for the GPU if it is still
+    // reading from it. Whatever comes before has already been copied into the region, and must not be invalidated
+    bool Graphics::mapRingRegion(size_t firstVertex, size_t firstIndexByte) {
+        GLsync fence = static_cast<GLsync>(ringFences[ringRegion]);
+
+        if(fence) {
+            GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+            while(result == GL_TIMEOUT_EXPIRED) {
+                result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+            }
+            glDeleteSync(fence);
+            ringFences[ringRegion] = nullptr;
+        }
+
+        const size_t vertexRegionSize = vertexCapacity * vertexStride;
+        const size_t indexRegionSize = indexCapacity;
+        const size_t indexRegionOffset = QUAD_PATTERN_SIZE + (ringRegion * indexRegionSize);
+
+        mappedVertexStart = firstVertex;
+        mappedIndexStart = firstIndexByte;
+
+        const size_t vertexStart = (ringRegion * vertexRegionSize) + (firstVertex * vertexStride);
+        const size_t indexStart = indexRegionOffset + firstIndexByte;
+
+        if(persistentMapping) {
+            if(!mappedVertices || !mappedIndices)
+                return false;
+            vertexData = mappedVertices + vertexStart;
+            indexData = mappedIndices + indexStart;
+            return true;
+        }
+
+        // Synchronization is done by the fence above, so the driver does not need to do it for us
+        vertexData = static_cast<uint8_t*>(backend->mapBuffer(VBO, vertexStart, vertexRegionSize - (firstVertex * vertexStride), MapMode_Unsynchronized));
+        indexData = static_cast<uint8_t*>(backend->mapBuffer(EBO, indexStart, indexRegionSize - firstIndexByte, MapMode_Unsynchronized));
+
+        return vertexData != nullptr && indexData != nullptr;
+    }
+
+    void Graphics::unmapRingRegion() {
+        if(persistentMapping)
+            return;
+
+        if(vertexData) {
+            backend->unmapBuffer(VBO);
+            vertexData = nullptr;
+        }
+
+        if(indexData) {
+            backend->unmapBuffer(EBO);
+            indexData = nullptr;
+        }
+    }
+
+    // Fences the region that was just submitted and moves on to the next one
+    void Graphics::advanceRingRegion() {
+        ringFences[ringRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        ringRegion = (ringRegion + 1) % RING_BUFFER_REGIONS;
+
+        if(!mapRingRegion()) {
+            std::cerr << "Failed to map ring buffer, falling back to BufferUploadMode_SubData" << std::endl;
+            reallocateBuffers(BufferUploadMode_SubData, vertexCapacity, indexCapacity);
+        }
+    }
+
+    // Compiling and linking is left to the backend, programs of Graphics all declare the frame uniform block
+    uint32_t Graphics::createProgram(const std::string &vertexSource, const std::string &fragmentSource) {
+        const uint32_t program = backend->createProgram(vertexSource, fragmentSource);
+
+        if(program > 0)
+            Shader::bindFrameUniforms(program);
+
+        return program;
+    }
+
+    void Graphics::createShader() {
+        std::string vertexSource = R"(#version 330 core
+layout(location = 0) in vec2 aPosition;
+layout(location = 1) in vec2 aTexCoord;
+layout(location = 2) in vec4 aColor;
+
+layout(std140) uniform VexedFrame {
+    mat4 uProjection;
+    vec4 uViewport;
+    float uTime;
+};
+
+uniform mat4 uModel;
+
+out vec2 oTexCoord;
+out vec4 oColor;
+
+void main() {
+    gl_Position = uProjection * uModel * vec4(aPosition.x, aPosition.y, 0.0, 1.0);
+    oTexCoord = aTexCoord;
+    oColor = aColor;
+})";
+
+        std::string fragmentSource = R"(#version 330 core
+uniform sampler2D uTexture;
+uniform int uIsFont;
+
+in vec2 oTexCoord;
+in vec4 oColor;
+out vec4 FragColor;
+
+void main() {
+    if(uIsFont > 0) {
+        vec4 sample = texture(uTexture, oTexCoord);
+        if(sample.r == 0)
+            discard;
+        //FragColor = sample.r * oColor;
+        float d = sample.r;
+        float aaf = fwidth(d);
+        float alpha = smoothstep(0.5 - aaf, 0.5 + aaf, d);
+        FragColor = vec4(oColor.rgb, alpha) * oColor;
+    } else {
+        FragColor = texture(uTexture, oTexCoord) * oColor;
+    }
+})";
+
+        shaderId = createProgram(vertexSource, fragmentSource);
+
+        uniforms[Uniform_Texture] = glGetUniformLocation(shaderId, "uTexture");
+        uniforms[Uniform_IsFont] = glGetUniformLocation(shaderId, "uIsFont");
+    }
+
+    void Graphics::createInstanceShader() {
+        std::string vertexSource = R"(#version 330 core
+layout(location = 0) in vec2 aCorner;
+layout(location = 1) in vec2 aPosition;
+layout(location = 2) in vec2 aSize;
+layout(location = 3) in vec2 aUV0;
+layout(location = 4) in vec2 aUV1;
+layout(location = 5) in vec4 aColor;
+layout(location = 6) in float aRotation;
+layout(location = 7) in uint aKind;
+layout(location = 8) in vec2 aShape;
+
+layout(std140) uniform VexedFrame {
+    mat4 uProjection;
+    vec4 uViewport;
+    float uTime;
+};
+
+uniform mat4 uModel;
+
+out vec2 oTexCoord;
+out vec4 oColor;
+out vec2 oLocal;
+flat out uint oKind;
+flat out vec2 oShape;
+
+void main() {
+    vec2 halfSize = aSize * 0.5;
+    vec2 local = (aCorner - 0.5) * aSize;
+    float c = cos(aRotation);
+    float s = sin(aRotation);
+    vec2 rotated = vec2(local.x * c - local.y * s, local.x * s + local.y * c);
+    vec2 position = aPosition + halfSize + rotated;
+    gl_Position = uProjection * uModel * vec4(position.x, position.y, 0.0, 1.0);
+    oTexCoord = mix(aUV0, aUV1, aCorner);
+    oColor = aColor;
+    oLocal = aCorner * 2.0 - 1.0;
+    oKind = aKind;
+    oShape = aShape;
+})";
+
+        std::string fragmentSource = R"(#version 330 core
+uniform sampler2D uTexture;
+
+in vec2 oTexCoord;
+in vec4 oColor;
+in vec2 oLocal;
+flat in uint oKind;
+flat in vec2 oShape;
+out vec4 FragColor;
+
+// Signed distance in pixels to an ellipse given in local coordinates, the implicit function is divided by its gradient
+float getEllipseDistance(vec2 local, vec2 halfSize) {
+    float l = max(length(local), 1e-6);
+    return (l - 1.0) / length((local / l) / halfSize);
+}
+
+float getBoxDistance(vec2 p, vec2 halfSize, float radius) {
+    vec2 q = abs(p) - halfSize + radius;
+    return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - radius;
+}
+
+float getCoverage(float d) {
+    return clamp(0.5 - d, 0.0, 1.0);
+}
+
+// The local coordinates span [-1, 1] over the shape, so the size in pixels follows from how fast they change on screen
+float getShapeCoverage(vec2 local, vec2 halfSize) {
+    float radius = oShape.x;
+    float thickness = oShape.y;
+
+    if(radius < 0.0) {
+        float coverage = getCoverage(getEllipseDistance(local, halfSize));
+        if(thickness > 0.0) {
+            vec2 innerHalfSize = halfSize - thickness;
+            if(innerHalfSize.x > 0.0 && innerHalfSize.y > 0.0)
+                coverage *= 1.0 - getCoverage(getEllipseDistance(local * halfSize / innerHalfSize, innerHalfSize));
+        }
+        return coverage;
+    }
+
+    radius = min(radius, min(halfSize.x, halfSize.y));
+    float d = getBoxDistance(local * halfSize, halfSize, radius);
+    float coverage = getCoverage(d);
+    if(thickness > 0.0)
+        coverage *= 1.0 - getCoverage(d + thickness);
+    return coverage;
+}
+
+void main() {
+    if(oKind == 2u) {
+        vec2 halfSize = 1.0 / max(vec2(length(vec2(dFdx(oTexCoord.x), dFdy(oTexCoord.x))), length(vec2(dFdx(oTexCoord.y), dFdy(oTexCoord.y)))), vec2(1e-6));
+        vec4 color = texture(uTexture, oTexCoord * 0.5 + 0.5) * oColor;
+        color.a *= getShapeCoverage(oTexCoord, halfSize);
+        if(color.a <= 0.0)
+            discard;
+        FragColor = color;
+        return;
+    }
+
+    vec4 color = texture(uTexture, oTexCoord) * oColor;
+    if(oKind == 1u) {
+        float d = length(oLocal);
+        float aaf = fwidth(d);
+        color.a *= 1.0 - smoothstep(1.0 - aaf, 1.0, d);
+        if(color.a <= 0.0)
+            discard;
+    }
+    FragColor = color;
+})";
+
+        instanceShaderId = createProgram(vertexSource, fragmentSource);
+
+        instanceUniforms[Uniform_Texture] = glGetUniformLocation(instanceShaderId, "uTexture");
+        instanceUniforms[Uniform_IsFont] = -1;
+    }
+
+    void Graphics::createPlotShader() {
+        std::string vertexSource = R"(#version 330 core
+layout(std140) uniform VexedFrame {
+    mat4 uProjection;
+    vec4 uViewport;
+    float uTime;
+};
+
+uniform samplerBuffer uSamples;
+uniform int uStart;
+uniform int uCapacity;
+uniform vec4 uRectangle;
+uniform vec2 uScale;
+uniform float uThickness;
+
+// The full capacity spans the width of the rectangle, a buffer that is not full yet covers the left part
+vec2 getPoint(int index) {
+    float value = texelFetch(uSamples, (uStart + index) % uCapacity).r;
+    float step = uRectangle.z / float(uCapacity - 1);
+    return vec2(uRectangle.x + float(index) * step, uRectangle.y + (value * uScale.x + uScale.y) * uRectangle.w);
+}
+
+void main() {
+    const int corners[6] = int[6](0, 1, 2, 0, 2, 3);
+    int segment = gl_VertexID / 6;
+    int corner = corners[gl_VertexID % 6];
+
+    vec2 p1 = getPoint(segment);
+    vec2 p2 = getPoint(segment + 1);
+    vec2 direction = p2 - p1;
+    float len = length(direction);
+    vec2 normal = len > 0.0 ? vec2(-direction.y, direction.x) / len * (uThickness * 0.5) : vec2(0.0);
+
+    vec2 position = (corner < 2 ? p1 : p2) + ((corner == 0 || corner == 3) ? normal : -normal);
+    gl_Position = uProjection * vec4(position, 0.0, 1.0);
+})";
+
+        std::string fragmentSource = R"(#version 330 core
+uniform vec4 uColor;
+
+out vec4 FragColor;
+
+void main() {
+    FragColor = uColor;
+})";
+
+        plotShaderId = createProgram(vertexSource, fragmentSource);
+
+        plotUniforms[PlotUniform_Samples] = glGetUniformLocation(plotShaderId, "uSamples");
+        plotUniforms[PlotUniform_Start] = glGetUniformLocation(plotShaderId, "uStart");
+        plotUniforms[PlotUniform_Capacity] = glGetUniformLocation(plotShaderId, "uCapacity");
+        plotUniforms[PlotUniform_Rectangle] = glGetUniformLocation(plotShaderId, "uRectangle");
+        plotUniforms[PlotUniform_Scale] = glGetUniformLocation(plotShaderId, "uScale");
+        plotUniforms[PlotUniform_Thickness] = glGetUniformLocation(plotShaderId, "uThickness");
+        plotUniforms[PlotUniform_Color] = glGetUniformLocation(plotShaderId, "uColor");
+    }
+
+    void Graphics::createFrameUniformBuffer() {
+        memset(&frameUniforms, 0, sizeof(FrameUniforms));
+
+        frameUBO = backend->createBuffer();
+        backend->allocateBuffer(frameUBO, sizeof(FrameUniforms), nullptr, BufferUsage_Dynamic);
+    }
+
+    void Graphics::createInstanceBuffers() {
+        instances.resize(1024);
+
+        const float corners[8] = {
+            0.0f, 0.0f, // top left
+            0.0f, 1.0f, // bottom left
+            1.0f, 1.0f, // bottom right
+            1.0f, 0.0f  // top right
+        };
+
+        const uint32_t quadIndices[6] = {
+            0, 1, 2,
+            0, 2, 3
+        };
+
+        glGenVertexArrays(1, &instanceVAO);
+        quadVBO = backend->createBuffer();
+        quadEBO = backend->createBuffer();
+        instanceVBO = backend->createBuffer();
+
+        stateCache.bindVertexArray(instanceVAO);
+
+        stateCache.bindBuffer(GL_ARRAY_BUFFER, quadVBO);
+        backend->allocateBuffer(quadVBO, sizeof(corners), corners, BufferUsage_Static);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (GLvoid*)0);
+        glEnableVertexAttribArray(0);
+
+        stateCache.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadEBO);
+        backend->allocateBuffer(quadEBO, sizeof(quadIndices), quadIndices, BufferUsage_Static);
+
+        stateCache.bindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        backend->allocateBuffer(instanceVBO, instances.size() * sizeof(InstanceData), nullptr, BufferUsage_Stream);
+
+        for(uint32_t i = 1; i <= 8; i++) {
+            glEnableVertexAttribArray(i);
+            glVertexAttribDivisor(i, 1);
+        }
+
+        setInstanceAttributes(instanceVBO, 0);
+
+        stateCache.bindVertexArray(0);
+        stateCache.bindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // GL 3.3 has no base instance for instanced draws, so the per-instance attributes are pointed at the first instance of the item instead
+    // Expects the instanced VAO to be bound
+    void Graphics::setInstanceAttributes(uint32_t instanceBuffer, size_t instanceOffset) {
+        const size_t base = instanceOffset * sizeof(InstanceData);
+        const GLsizei stride = sizeof(InstanceData);
+
+        stateCache.bindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(base + offsetof(InstanceData, position)));
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(base + offsetof(InstanceData, size)));
+        glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(base + offsetof(InstanceData, uv0)));
+        glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(base + offsetof(InstanceData, uv1)));
+        glVertexAttribPointer(5, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (GLvoid*)(base + offsetof(InstanceData, color)));
+        glVertexAttribPointer(6, 1, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(base + offsetof(InstanceData, rotation)));
+        glVertexAttribIPointer(7, 1, GL_UNSIGNED_INT, stride, (GLvoid*)(base + offsetof(InstanceData, kind)));
+        glVertexAttribPointer(8, 2, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(base + offsetof(InstanceData, shape)));
+    }
+
+    void Graphics::createTexture() {
+        unsigned char textureData[16];
+        memset(textureData, 255, 16);
 
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 2, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE, textureData);
+        TextureDescription description;
+        description.width = 2;
+        description.height = 2;
+        description.channels = 4;
+        description.format = TextureFormat_RGBA8;
+        description.wrapS = GL_CLAMP_TO_EDGE;
+        description.wrapT = GL_CLAMP_TO_EDGE;
+        description.minFilter = GL_LINEAR;
+        description.magFilter = GL_LINEAR;
+        description.mipmaps = false;
+        description.data = textureData;
+
+        textureId = backend->createTexture(description);
+
+        // The backend leaves the texture unit without a binding
+        stateCache.invalidateTexture();
     }
 }
\ No newline at end of file
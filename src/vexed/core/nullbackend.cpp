@@ -0,0 +1,271 @@
+#include "nullbackend.h"
+#include "../../glad/glad.h"
+#include <cstdint>
+#include <cstring>
+
+// Every entry point the library (or a typical uniform callback) calls outside of the backend
+#define VEXED_NULL_ENTRY_POINTS(X) \
+    X(ActiveTexture) X(AttachShader) X(BeginQuery) X(BindBuffer) X(BindBufferBase) X(BindFramebuffer) X(BindTexture) X(BindVertexArray) \
+    X(BlendEquation) X(BlendFunc) X(BlendFuncSeparate) X(BufferData) X(BufferStorage) X(BufferSubData) X(Clear) X(ClearColor) X(ClientWaitSync) \
+    X(CompileShader) X(CreateProgram) X(CreateShader) X(DeleteBuffers) X(DeleteProgram) X(DeleteQueries) X(DeleteShader) \
+    X(DeleteSync) X(DeleteTextures) X(DeleteVertexArrays) X(DepthFunc) X(DetachShader) X(Disable) X(DrawArrays) \
+    X(DrawElementsBaseVertex) X(DrawElementsInstanced) X(Enable) X(EnableVertexAttribArray) X(EndQuery) X(FenceSync) \
+    X(Finish) X(Flush) X(GenBuffers) X(GenQueries) X(GenTextures) X(GenVertexArrays) X(GenerateMipmap) X(GetError) \
+    X(GetIntegerv) X(GetProgramInfoLog) X(GetProgramiv) X(GetQueryObjectiv) X(GetQueryObjectui64v) X(GetShaderInfoLog) \
+    X(GetShaderiv) X(GetUniformBlockIndex) X(GetUniformLocation) X(IsEnabled) X(LinkProgram) X(MapBufferRange) \
+    X(MultiDrawElementsBaseVertex) X(PixelStorei) X(Scissor) X(ShaderSource) X(TexBuffer) X(TexImage2D) X(TexParameteri) \
+    X(TexSubImage2D) X(Uniform1f) X(Uniform1i) X(Uniform1iv) X(Uniform2f) X(Uniform2fv) X(Uniform3f) X(Uniform3fv) \
+    X(Uniform4f) X(Uniform4fv) X(UniformBlockBinding) X(UniformMatrix4fv) X(UnmapBuffer) X(UseProgram) \
+    X(VertexAttribDivisor) X(VertexAttribIPointer) X(VertexAttribPointer) X(Viewport)
+
+namespace vexed {
+    template<typename T>
+    struct NullEntryPoint;
+
+    template<typename R, typename... Args>
+    struct NullEntryPoint<R (APIENTRYP)(Args...)> {
+        static R APIENTRY call(Args...) { return R(); }
+    };
+
+    // Names handed out by the entry points that create objects, they only have to be unique and non zero
+    static GLuint nextObjectName = 1;
+
+    static void APIENTRY nullGenNames(GLsizei n, GLuint *names) {
+        for(GLsizei i = 0; i < n; i++)
+            names[i] = nextObjectName++;
+    }
+
+    static GLuint APIENTRY nullCreateObject() {
+        return nextObjectName++;
+    }
+
+    static GLuint APIENTRY nullCreateShader(GLenum) {
+        return nextObjectName++;
+    }
+
+    static void APIENTRY nullGetShaderiv(GLuint, GLenum pname, GLint *params) {
+        *params = (pname == GL_COMPILE_STATUS || pname == GL_LINK_STATUS) ? GL_TRUE : 0;
+    }
+
+    static void APIENTRY nullGetIntegerv(GLenum pname, GLint *data) {
+        const int count = (pname == GL_VIEWPORT || pname == GL_SCISSOR_BOX) ? 4 : 1;
+        for(int i = 0; i < count; i++)
+            data[i] = 0;
+    }
+
+    static GLint APIENTRY nullGetUniformLocation(GLuint, const GLchar*) {
+        return -1;
+    }
+
+    static GLuint APIENTRY nullGetUniformBlockIndex(GLuint, const GLchar*) {
+        return GL_INVALID_INDEX;
+    }
+
+    static GLboolean APIENTRY nullUnmapBuffer(GLenum) {
+        return GL_TRUE;
+    }
+
+    static GLsync APIENTRY nullFenceSync(GLenum, GLbitfield) {
+        return reinterpret_cast<GLsync>(static_cast<uintptr_t>(1));
+    }
+
+    static GLenum APIENTRY nullClientWaitSync(GLsync, GLbitfield, GLuint64) {
+        return GL_ALREADY_SIGNALED;
+    }
+
+    static void APIENTRY nullGetQueryObjectiv(GLuint, GLenum pname, GLint *params) {
+        *params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+    }
+
+    static void APIENTRY nullGetQueryObjectui64v(GLuint, GLenum, GLuint64 *params) {
+        *params = 0;
+    }
+
+    // Entry points that were loaded before the null backend got activated
+    struct SavedEntryPoints {
+        #define X(name) decltype(glad_gl##name) name;
+        VEXED_NULL_ENTRY_POINTS(X)
+        #undef X
+    };
+
+    static SavedEntryPoints savedEntryPoints;
+
+    NullBackend::NullBackend() {
+        nextName = 1;
+        uploadedBytes = 0;
+        numSubmissions = 0;
+        recording = true;
+        active = false;
+    }
+
+    void NullBackend::activate() {
+        if(active)
+            return;
+
+        #define X(name) savedEntryPoints.name = glad_gl##name; glad_gl##name = NullEntryPoint<decltype(glad_gl##name)>::call;
+        VEXED_NULL_ENTRY_POINTS(X)
+        #undef X
+
+        glad_glGenBuffers = nullGenNames;
+        glad_glGenTextures = nullGenNames;
+        glad_glGenVertexArrays = nullGenNames;
+        glad_glGenQueries = nullGenNames;
+        glad_glCreateProgram = nullCreateObject;
+        glad_glCreateShader = nullCreateShader;
+        glad_glGetShaderiv = nullGetShaderiv;
+        glad_glGetProgramiv = nullGetShaderiv;
+        glad_glGetIntegerv = nullGetIntegerv;
+        glad_glGetUniformLocation = nullGetUniformLocation;
+        glad_glGetUniformBlockIndex = nullGetUniformBlockIndex;
+        glad_glUnmapBuffer = nullUnmapBuffer;
+        glad_glFenceSync = nullFenceSync;
+        glad_glClientWaitSync = nullClientWaitSync;
+        glad_glGetQueryObjectiv = nullGetQueryObjectiv;
+        glad_glGetQueryObjectui64v = nullGetQueryObjectui64v;
+
+        active = true;
+    }
+
+    void NullBackend::deactivate() {
+        if(!active)
+            return;
+
+        #define X(name) glad_gl##name = savedEntryPoints.name;
+        VEXED_NULL_ENTRY_POINTS(X)
+        #undef X
+
+        active = false;
+    }
+
+    uint32_t NullBackend::createBuffer() {
+        const uint32_t buffer = nextName++;
+        record(BackendCommandType_CreateBuffer, buffer, 0);
+        return buffer;
+    }
+
+    void NullBackend::destroyBuffer(uint32_t buffer) {
+        if(buffer == 0)
+            return;
+        storage.erase(buffer);
+        bufferSizes.erase(buffer);
+        record(BackendCommandType_DestroyBuffer, buffer, 0);
+    }
+
+    void NullBackend::allocateBuffer(uint32_t buffer, size_t size, const void *data, BufferUsage) {
+        bufferSizes[buffer] = size;
+        storage.erase(buffer);
+        record(BackendCommandType_AllocateBuffer, buffer, data ? size : 0);
+    }
+
+    void NullBackend::allocatePersistentBuffer(uint32_t buffer, size_t size) {
+        allocateBuffer(buffer, size, nullptr, BufferUsage_Stream);
+    }
+
+    void NullBackend::updateBuffer(uint32_t buffer, size_t offset, size_t size, const void *data) {
+        auto it = storage.find(buffer);
+        if(it != storage.end() && offset + size <= it->second.size() && data)
+            memcpy(it->second.data() + offset, data, size);
+        record(BackendCommandType_UpdateBuffer, buffer, size);
+    }
+
+    // The whole buffer is backed by memory the first time it is mapped, later maps return a range of the same memory
+    void *NullBackend::mapBuffer(uint32_t buffer, size_t offset, size_t size, MapMode mode) {
+        auto sizeIt = bufferSizes.find(buffer);
+
+        if(sizeIt == bufferSizes.end() || offset + size > sizeIt->second)
+            return nullptr;
+
+        std::vector<uint8_t> &memory = storage[buffer];
+
+        if(memory.size() != sizeIt->second)
+            memory.resize(sizeIt->second);
+
+        // A persistent mapping is written to for many frames, so only unsynchronized ranges count as uploaded
+        record(BackendCommandType_MapBuffer, buffer, mode == MapMode_Persistent ? 0 : size);
+        return memory.data() + offset;
+    }
+
+    void NullBackend::unmapBuffer(uint32_t) {
+    }
+
+    // Only memory behind buffers that have been mapped is copied, nothing is uploaded since the data never leaves the GPU
+    void NullBackend::copyBuffer(uint32_t source, uint32_t destination, size_t sourceOffset, size_t destinationOffset, size_t size) {
+        auto sourceIt = storage.find(source);
+        auto sizeIt = bufferSizes.find(destination);
+
+        if(sourceIt != storage.end() && sizeIt != bufferSizes.end() && sourceOffset + size <= sourceIt->second.size() && destinationOffset + size <= sizeIt->second) {
+            const std::vector<uint8_t> data(sourceIt->second.begin() + sourceOffset, sourceIt->second.begin() + sourceOffset + size);
+            std::vector<uint8_t> &memory = storage[destination];
+            if(memory.size() != sizeIt->second)
+                memory.resize(sizeIt->second);
+            memcpy(memory.data() + destinationOffset, data.data(), size);
+        }
+
+        record(BackendCommandType_CopyBuffer, destination, 0);
+    }
+
+    uint32_t NullBackend::createTexture(const TextureDescription &description) {
+        const uint32_t texture = nextName++;
+        const size_t bytes = description.data ? static_cast<size_t>(description.width) * description.height * description.channels : 0;
+        record(BackendCommandType_CreateTexture, texture, bytes);
+        return texture;
+    }
+
+    void NullBackend::updateTexture(uint32_t texture, uint32_t, uint32_t, uint32_t width, uint32_t height, uint32_t channels, const void*) {
+        record(BackendCommandType_UpdateTexture, texture, static_cast<size_t>(width) * height * channels);
+    }
+
+    void NullBackend::destroyTexture(uint32_t texture) {
+        if(texture > 0)
+            record(BackendCommandType_DestroyTexture, texture, 0);
+    }
+
+    uint32_t NullBackend::createFramebuffer(uint32_t) {
+        const uint32_t framebuffer = nextName++;
+        record(BackendCommandType_CreateFramebuffer, framebuffer, 0);
+        return framebuffer;
+    }
+
+    void NullBackend::destroyFramebuffer(uint32_t framebuffer) {
+        if(framebuffer > 0)
+            record(BackendCommandType_DestroyFramebuffer, framebuffer, 0);
+    }
+
+    uint32_t NullBackend::createProgram(const std::string&, const std::string&) {
+        const uint32_t program = nextName++;
+        record(BackendCommandType_CreateProgram, program, 0);
+        return program;
+    }
+
+    void NullBackend::destroyProgram(uint32_t program) {
+        if(program > 0) {
+            record(BackendCommandType_DestroyProgram, program, 0);
+            destroyedPrograms++;
+        }
+    }
+
+    void NullBackend::submit(const DrawSubmission &submission) {
+        size_t count = 0;
+        for(size_t i = 0; i < submission.drawCount; i++)
+            count += submission.counts[i];
+        if(submission.kind == SubmissionKind_ElementsInstanced)
+            count *= submission.instanceCount;
+
+        numSubmissions++;
+
+        if(recording)
+            commands.push_back({ BackendCommandType_Submit, 0, count });
+    }
+
+    void NullBackend::clear() {
+        commands.clear();
+        uploadedBytes = 0;
+        numSubmissions = 0;
+    }
+
+    void NullBackend::record(BackendCommandType type, uint32_t id, size_t bytes) {
+        uploadedBytes += bytes;
+        if(recording)
+            commands.push_back({ type, id, bytes });
+    }
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include "plotbuffer.h"
+#include "backend.h"
+#include "../../glad/glad.h"
+#include <iostream>
+#include <algorithm>
+
+namespace vexed {
+    PlotBuffer::PlotBuffer() {
+        buffer = 0;
+        texture = 0;
+        capacity = 0;
+        head = 0;
+        count = 0;
+        uploadedBytes = 0;
+        revision = 0;
+    }
+
+    bool PlotBuffer::create(size_t capacity) {
+        if(capacity < 2) {
+            std::cerr << "PlotBuffer::create needs room for at least 2 samples" << std::endl;
+            return false;
+        }
+
+        GLint maxTexels = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+
+        if(maxTexels > 0 && capacity > static_cast<size_t>(maxTexels)) {
+            std::cerr << "PlotBuffer::create capacity of " << capacity << " exceeds the texture buffer limit of " << maxTexels << std::endl;
+            return false;
+        }
+
+        destroy();
+
+        Backend *backend = Backend::getInstance();
+
+        buffer = backend->createBuffer();
+        backend->allocateBuffer(buffer, capacity * sizeof(float), nullptr, BufferUsage_Dynamic);
+
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_BUFFER, texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_R32F, buffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+        this->capacity = capacity;
+        clear();
+
+        return true;
+    }
+
+    void PlotBuffer::destroy() {
+        if(texture > 0) {
+            glDeleteTextures(1, &texture);
+            texture = 0;
+        }
+
+        if(buffer > 0) {
+            Backend::getInstance()->destroyBuffer(buffer);
+            buffer = 0;
+        }
+
+        capacity = 0;
+        clear();
+    }
+
+    void PlotBuffer::append(float value) {
+        append(&value, 1);
+    }
+
+    void PlotBuffer::append(const float *values, size_t count) {
+        if(values == nullptr || count == 0 || capacity == 0)
+            return;
+
+        pending.insert(pending.end(), values, values + count);
+
+        // Samples that were overwritten before they were ever uploaded do not need to be kept
+        if(pending.size() >= capacity * 2)
+            pending.erase(pending.begin(), pending.end() - capacity);
+
+        head = (head + count) % capacity;
+        this->count = std::min(this->count + count, capacity);
+        revision++;
+    }
+
+    void PlotBuffer::clear() {
+        head = 0;
+        count = 0;
+        pending.clear();
+        revision++;
+    }
+
+    // Writes the pending samples to their ring positions, at most two uploads when they wrap around the end
+    void PlotBuffer::upload() {
+        uploadedBytes = 0;
+
+        if(pending.empty() || buffer == 0)
+            return;
+
+        const float *source = pending.data();
+        size_t numSamples = pending.size();
+
+        if(numSamples > capacity) {
+            source += numSamples - capacity;
+            numSamples = capacity;
+        }
+
+        const size_t start = (head + capacity - numSamples) % capacity;
+        const size_t first = std::min(numSamples, capacity - start);
+
+        Backend *backend = Backend::getInstance();
+
+        backend->updateBuffer(buffer, start * sizeof(float), first * sizeof(float), source);
+
+        if(numSamples > first)
+            backend->updateBuffer(buffer, 0, (numSamples - first) * sizeof(float), source + first);
+
+        uploadedBytes = numSamples * sizeof(float);
+        pending.clear();
+    }
+}
\ No newline at end of file
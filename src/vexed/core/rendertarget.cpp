@@ -0,0 +1,72 @@
+#include "rendertarget.h"
+#include "backend.h"
+#include "../../glad/glad.h"
+#include <iostream>
+
+namespace vexed {
+    RenderTarget::RenderTarget() {
+        framebuffer = 0;
+        texture = 0;
+        width = 0;
+        height = 0;
+        origin = Vector2(0, 0);
+    }
+
+    bool RenderTarget::create(uint32_t width, uint32_t height) {
+        if(width == 0 || height == 0) {
+            std::cerr << "RenderTarget::create needs a size of at least 1x1" << std::endl;
+            return false;
+        }
+
+        if(isValid() && this->width == width && this->height == height)
+            return true;
+
+        destroy();
+
+        Backend *backend = Backend::getInstance();
+
+        // Mipmaps are not used, the texture is meant to be shown at the size it was rendered at
+        TextureDescription description;
+        description.width = width;
+        description.height = height;
+        description.channels = 4;
+        description.format = TextureFormat_RGBA8;
+        description.wrapS = GL_CLAMP_TO_EDGE;
+        description.wrapT = GL_CLAMP_TO_EDGE;
+        description.minFilter = GL_LINEAR;
+        description.magFilter = GL_LINEAR;
+        description.mipmaps = false;
+        description.data = nullptr;
+
+        texture = backend->createTexture(description);
+        framebuffer = backend->createFramebuffer(texture);
+
+        if(framebuffer == 0) {
+            backend->destroyTexture(texture);
+            texture = 0;
+            return false;
+        }
+
+        this->width = width;
+        this->height = height;
+        return true;
+    }
+
+    void RenderTarget::destroy() {
+        Backend *backend = Backend::getInstance();
+
+        if(framebuffer > 0) {
+            backend->destroyFramebuffer(framebuffer);
+            framebuffer = 0;
+        }
+
+        if(texture > 0) {
+            backend->destroyTexture(texture);
+            texture = 0;
+        }
+
+        drawList.destroy();
+        width = 0;
+        height = 0;
+    }
+}
\ No newline at end of file
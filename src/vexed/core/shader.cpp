@@ -1,6 +1,6 @@
 #include "shader.h"
+#include "backend.h"
 #include "../../glad/glad.h"
-#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -14,36 +14,12 @@ namespace vexed {
         if(id > 0)
             return false;
 
-        const GLchar* vertex_shader[1] = {
-            vertexSource.c_str()
-        };
-
-        const GLchar* fragment_shader[1] = {
-            fragmentSource.c_str()
-        };
-
-        GLuint vert_handle = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vert_handle, 1, vertex_shader, nullptr);
-        glCompileShader(vert_handle);
-        checkShader(vert_handle, "vertex shader");
-
-        GLuint frag_handle = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(frag_handle, 1, fragment_shader, nullptr);
-        glCompileShader(frag_handle);
-        bool check1 = checkShader(frag_handle, "fragment shader");
+        id = Backend::getInstance()->createProgram(vertexSource, fragmentSource);
 
-        id = glCreateProgram();
-        glAttachShader(id, vert_handle);
-        glAttachShader(id, frag_handle);
-        glLinkProgram(id);
-        bool check2 = checkProgram(id, "shader program");
-
-        glDetachShader(id, vert_handle);
-        glDetachShader(id, frag_handle);
-        glDeleteShader(vert_handle);
-        glDeleteShader(frag_handle);
+        if(id > 0)
+            bindFrameUniforms(id);
 
-        return (check1 == true && check2 == true);
+        return id > 0;
     }
 
     bool Shader::loadFromFile(const std::string &vertexPath, const std::string &fragmentPath) {
@@ -68,40 +44,23 @@ namespace vexed {
     
     void Shader::destroy() {
         if(id > 0) {
-            glDeleteProgram(id);
+            Backend::getInstance()->destroyProgram(id);
             id = 0;
         }
     }
 
-    bool Shader::checkShader(uint32_t handle, const std::string &description) {
-        GLint status = 0, log_length = 0;
-        glGetShaderiv(handle, GL_COMPILE_STATUS, &status);
-        glGetShaderiv(handle, GL_INFO_LOG_LENGTH, &log_length);
-        if (status == GL_FALSE)
-            fprintf(stderr, "ERROR: failed to compile %s!\n", description.c_str());
-        if (log_length > 1) {
-            std::vector<char> buf;
-            buf.resize((int)(log_length + 1));
-            glGetShaderInfoLog(handle, log_length, nullptr, &buf[0]);
-            fprintf(stderr, "%s\n", buf.begin());
-        }
+    void Shader::bindFrameUniforms(uint32_t programId) {
+        GLuint blockIndex = glGetUniformBlockIndex(programId, "VexedFrame");
+        if(blockIndex != GL_INVALID_INDEX)
+            glUniformBlockBinding(programId, blockIndex, FRAME_UNIFORM_BINDING);
 
-        return status == GL_TRUE;
-    }
+        // The block replaced plain uniforms, which Graphics still sets but at the cost of an upload per program
+        const char *legacyUniforms[] = { "uProjection", "uTime" };
 
-    bool Shader::checkProgram(GLuint handle, const std::string &description) {
-        GLint status = 0, log_length = 0;
-        glGetProgramiv(handle, GL_LINK_STATUS, &status);
-        glGetProgramiv(handle, GL_INFO_LOG_LENGTH, &log_length);
-        if (status == GL_FALSE)
-            fprintf(stderr, "ERROR: failed to link %s!n", description.c_str());
-        if (log_length > 1) {
-            std::vector<char> buf;
-            buf.resize((int)(log_length + 1));
-            glGetProgramInfoLog(handle, log_length, nullptr, &buf[0]);
-            fprintf(stderr, "%s\n", buf.begin());
+        for(const char *name : legacyUniforms) {
+            if(glGetUniformLocation(programId, name) >= 0)
+                std::cerr << "Program " << programId << " declares " << name << " outside of the VexedFrame uniform block, it is uploaded separately until the program declares the block" << std::endl;
         }
-        return status == GL_TRUE;
     }
 
     void Shader::setFloat(const char *name, float value) {
@@ -0,0 +1,511 @@
+#include "simd.h"
+#include <cmath>
+#include <cstddef>
+#include <atomic>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define VEXED_SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define VEXED_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+// AVX2 kernels are compiled for AVX2 regardless of the compiler flags and only called when the CPU supports it
+#if defined(VEXED_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define VEXED_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define VEXED_TARGET_AVX2
+#endif
+
+namespace vexed {
+    // The kernels load and store a vertex as two groups of four floats
+    static_assert(sizeof(Vertex) == 8 * sizeof(float), "Vertex is expected to be 8 floats");
+    static_assert(offsetof(Vertex, uv) == 2 * sizeof(float), "Vertex uv is expected to follow the position");
+    static_assert(offsetof(Vertex, color) == 4 * sizeof(float), "Vertex color is expected to follow the uv");
+
+    struct SimdKernels {
+        void (*fillColor)(Vertex *vertices, size_t numVertices, const Color &color);
+        void (*rotateVertices)(Vertex *vertices, size_t numVertices, float cosAngle, float sinAngle);
+        void (*extrudeSegments)(const Vector2 *segments, size_t count, float halfThickness, const Color &color, Vertex *quads);
+        void (*expandRectangles)(const Rectangle *rectangles, size_t count, const Color &color, Vertex *quads);
+    };
+
+    // All implementations rotate with x' = x * c - y * s + offset, so the levels give the same results up to the summation
+    // order of the centroid
+    static void computeRotationOffset(float centerX, float centerY, float c, float s, float &offsetX, float &offsetY) {
+        offsetX = centerX - (centerX * c - centerY * s);
+        offsetY = centerY - (centerX * s + centerY * c);
+    }
+
+    static void writeSegmentQuad(Vertex *quad, float x1, float y1, float x2, float y2, float perpendicularX, float perpendicularY, const Color &color) {
+        quad[0] = { Vector2(x1 + perpendicularX, y1 + perpendicularY), Vector2(0, 1), color };
+        quad[1] = { Vector2(x1 - perpendicularX, y1 - perpendicularY), Vector2(0, 0), color };
+        quad[2] = { Vector2(x2 - perpendicularX, y2 - perpendicularY), Vector2(1, 0), color };
+        quad[3] = { Vector2(x2 + perpendicularX, y2 + perpendicularY), Vector2(1, 1), color };
+    }
+
+    static void extrudeSegmentsScalar(const Vector2 *segments, size_t count, float halfThickness, const Color &color, Vertex *quads) {
+        for(size_t i = 0; i < count; i++) {
+            const Vector2 &p1 = segments[i*2+0];
+            const Vector2 &p2 = segments[i*2+1];
+            const float dx = p2.x - p1.x;
+            const float dy = p2.y - p1.y;
+            const float length = std::sqrt(dx * dx + dy * dy);
+            // Segments without length become empty quads
+            const float scale = length > 0.0f ? halfThickness / length : 0.0f;
+            writeSegmentQuad(&quads[i*4], p1.x, p1.y, p2.x, p2.y, -dy * scale, dx * scale, color);
+        }
+    }
+
+    static void fillColorScalar(Vertex *vertices, size_t numVertices, const Color &color) {
+        for(size_t i = 0; i < numVertices; i++)
+            vertices[i].color = color;
+    }
+
+    static void rotateVerticesScalar(Vertex *vertices, size_t numVertices, float c, float s) {
+        float centerX = 0.0f;
+        float centerY = 0.0f;
+
+        for(size_t i = 0; i < numVertices; i++) {
+            centerX += vertices[i].position.x;
+            centerY += vertices[i].position.y;
+        }
+
+        float offsetX, offsetY;
+        computeRotationOffset(centerX / numVertices, centerY / numVertices, c, s, offsetX, offsetY);
+
+        for(size_t i = 0; i < numVertices; i++) {
+            const float x = vertices[i].position.x;
+            const float y = vertices[i].position.y;
+            vertices[i].position.x = x * c - y * s + offsetX;
+            vertices[i].position.y = x * s + y * c + offsetY;
+        }
+    }
+
+    static void expandRectanglesScalar(const Rectangle *rectangles, size_t count, const Color &color, Vertex *quads) {
+        for(size_t i = 0; i < count; i++) {
+            const Rectangle &r = rectangles[i];
+            Vertex *quad = &quads[i*4];
+            quad[0] = { Vector2(r.x, r.y), Vector2(0, 1), color }; // top left
+            quad[1] = { Vector2(r.x, r.y + r.height), Vector2(0, 0), color }; // bottom left
+            quad[2] = { Vector2(r.x + r.width, r.y + r.height), Vector2(1, 0), color }; // bottom right
+            quad[3] = { Vector2(r.x + r.width, r.y), Vector2(1, 1), color }; // top right
+        }
+    }
+
+    static const SimdKernels scalarKernels = {
+        fillColorScalar,
+        rotateVerticesScalar,
+        extrudeSegmentsScalar,
+        expandRectanglesScalar
+    };
+
+#if defined(VEXED_SIMD_X86)
+    static void fillColorSSE2(Vertex *vertices, size_t numVertices, const Color &color) {
+        const __m128 c = _mm_loadu_ps(&color.r);
+        for(size_t i = 0; i < numVertices; i++)
+            _mm_storeu_ps(&vertices[i].color.r, c);
+    }
+
+    static void rotateVerticesSSE2(Vertex *vertices, size_t numVertices, float c, float s) {
+        __m128 sum = _mm_setzero_ps();
+        for(size_t i = 0; i < numVertices; i++)
+            sum = _mm_add_ps(sum, _mm_loadu_ps(&vertices[i].position.x));
+
+        float total[4];
+        _mm_storeu_ps(total, sum);
+
+        float offsetX, offsetY;
+        computeRotationOffset(total[0] / numVertices, total[1] / numVertices, c, s, offsetX, offsetY);
+
+        // Operates on (x, y, u, v), the uv lanes are multiplied by one and left untouched
+        const __m128 cosines = _mm_setr_ps(c, c, 1.0f, 1.0f);
+        const __m128 sines = _mm_setr_ps(s, -s, 0.0f, 0.0f);
+        const __m128 offset = _mm_setr_ps(offsetX, offsetY, 0.0f, 0.0f);
+
+        for(size_t i = 0; i < numVertices; i++) {
+            const __m128 v = _mm_loadu_ps(&vertices[i].position.x);
+            const __m128 swapped = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 2, 0, 1));
+            const __m128 r = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(v, cosines), _mm_mul_ps(swapped, sines)), offset);
+            _mm_storeu_ps(&vertices[i].position.x, r);
+        }
+    }
+
+    // Writes the quads of the segments whose coordinates are given in columns, lane i of each array belongs to segment index[i]
+    static void writeSegmentQuads(const float *x1, const float *y1, const float *x2, const float *y2, const float *px, const float *py,
+                                  const size_t *index, size_t lanes, const Color &color, Vertex *quads) {
+        for(size_t i = 0; i < lanes; i++)
+            writeSegmentQuad(&quads[index[i]*4], x1[i], y1[i], x2[i], y2[i], px[i], py[i], color);
+    }
+
+    static void extrudeSegmentsSSE2(const Vector2 *segments, size_t count, float halfThickness, const Color &color, Vertex *quads) {
+        const __m128 half = _mm_set1_ps(halfThickness);
+        const __m128 zero = _mm_setzero_ps();
+        const float *source = &segments[0].x;
+        size_t i = 0;
+
+        for(; i + 4 <= count; i += 4) {
+            // Every register holds one segment as (x1, y1, x2, y2), transposing turns them into columns
+            __m128 x1 = _mm_loadu_ps(source + (i+0) * 4);
+            __m128 y1 = _mm_loadu_ps(source + (i+1) * 4);
+            __m128 x2 = _mm_loadu_ps(source + (i+2) * 4);
+            __m128 y2 = _mm_loadu_ps(source + (i+3) * 4);
+            _MM_TRANSPOSE4_PS(x1, y1, x2, y2);
+
+            const __m128 dx = _mm_sub_ps(x2, x1);
+            const __m128 dy = _mm_sub_ps(y2, y1);
+            const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+            const __m128 scale = _mm_and_ps(_mm_cmpgt_ps(length, zero), _mm_div_ps(half, length));
+            const __m128 px = _mm_mul_ps(_mm_sub_ps(zero, dy), scale);
+            const __m128 py = _mm_mul_ps(dx, scale);
+
+            alignas(16) float columns[6][4];
+            _mm_store_ps(columns[0], x1);
+            _mm_store_ps(columns[1], y1);
+            _mm_store_ps(columns[2], x2);
+            _mm_store_ps(columns[3], y2);
+            _mm_store_ps(columns[4], px);
+            _mm_store_ps(columns[5], py);
+
+            const size_t index[4] = { i, i + 1, i + 2, i + 3 };
+            writeSegmentQuads(columns[0], columns[1], columns[2], columns[3], columns[4], columns[5], index, 4, color, quads);
+        }
+
+        extrudeSegmentsScalar(segments + (i * 2), count - i, halfThickness, color, quads + (i * 4));
+    }
+
+    static void expandRectanglesSSE2(const Rectangle *rectangles, size_t count, const Color &color, Vertex *quads) {
+        const __m128 c = _mm_loadu_ps(&color.r);
+        const __m128 uvTopLeft = _mm_setr_ps(0, 1, 0, 0);
+        const __m128 uvBottomLeft = _mm_setr_ps(0, 0, 0, 0);
+        const __m128 uvBottomRight = _mm_setr_ps(1, 0, 0, 0);
+        const __m128 uvTopRight = _mm_setr_ps(1, 1, 0, 0);
+
+        for(size_t i = 0; i < count; i++) {
+            const __m128 r = _mm_loadu_ps(&rectangles[i].x);
+            const __m128 end = _mm_add_ps(r, _mm_movehl_ps(r, r)); //(x + width, y + height)
+            const __m128 mixed = _mm_unpacklo_ps(r, end); //(x, x + width, y, y + height)
+            const __m128 bottomLeft = _mm_shuffle_ps(mixed, mixed, _MM_SHUFFLE(0, 0, 3, 0));
+            const __m128 topRight = _mm_shuffle_ps(mixed, mixed, _MM_SHUFFLE(0, 0, 2, 1));
+
+            Vertex *quad = &quads[i*4];
+            _mm_storeu_ps(&quad[0].position.x, _mm_movelh_ps(r, uvTopLeft));
+            _mm_storeu_ps(&quad[1].position.x, _mm_movelh_ps(bottomLeft, uvBottomLeft));
+            _mm_storeu_ps(&quad[2].position.x, _mm_movelh_ps(end, uvBottomRight));
+            _mm_storeu_ps(&quad[3].position.x, _mm_movelh_ps(topRight, uvTopRight));
+            _mm_storeu_ps(&quad[0].color.r, c);
+            _mm_storeu_ps(&quad[1].color.r, c);
+            _mm_storeu_ps(&quad[2].color.r, c);
+            _mm_storeu_ps(&quad[3].color.r, c);
+        }
+    }
+
+    static const SimdKernels sse2Kernels = {
+        fillColorSSE2,
+        rotateVerticesSSE2,
+        extrudeSegmentsSSE2,
+        expandRectanglesSSE2
+    };
+
+    VEXED_TARGET_AVX2 static __m256 loadVertexPair(const Vertex *vertices) {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&vertices[0].position.x)), _mm_loadu_ps(&vertices[1].position.x), 1);
+    }
+
+    VEXED_TARGET_AVX2 static void rotateVerticesAVX2(Vertex *vertices, size_t numVertices, float c, float s) {
+        // Two vertices per register, as (x, y, u, v) of each
+        __m256 sum = _mm256_setzero_ps();
+        size_t i = 0;
+
+        for(; i + 2 <= numVertices; i += 2)
+            sum = _mm256_add_ps(sum, loadVertexPair(&vertices[i]));
+
+        __m128 total4 = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+        if(i < numVertices)
+            total4 = _mm_add_ps(total4, _mm_loadu_ps(&vertices[i].position.x));
+
+        float total[4];
+        _mm_storeu_ps(total, total4);
+
+        float offsetX, offsetY;
+        computeRotationOffset(total[0] / numVertices, total[1] / numVertices, c, s, offsetX, offsetY);
+
+        const __m256 cosines = _mm256_setr_ps(c, c, 1.0f, 1.0f, c, c, 1.0f, 1.0f);
+        const __m256 sines = _mm256_setr_ps(s, -s, 0.0f, 0.0f, s, -s, 0.0f, 0.0f);
+        const __m256 offset = _mm256_setr_ps(offsetX, offsetY, 0.0f, 0.0f, offsetX, offsetY, 0.0f, 0.0f);
+
+        for(i = 0; i + 2 <= numVertices; i += 2) {
+            const __m256 v = loadVertexPair(&vertices[i]);
+            const __m256 swapped = _mm256_permute_ps(v, _MM_SHUFFLE(3, 2, 0, 1));
+            const __m256 r = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(v, cosines), _mm256_mul_ps(swapped, sines)), offset);
+            _mm_storeu_ps(&vertices[i+0].position.x, _mm256_castps256_ps128(r));
+            _mm_storeu_ps(&vertices[i+1].position.x, _mm256_extractf128_ps(r, 1));
+        }
+
+        if(i < numVertices) {
+            const float x = vertices[i].position.x;
+            const float y = vertices[i].position.y;
+            vertices[i].position.x = x * c - y * s + offsetX;
+            vertices[i].position.y = x * s + y * c + offsetY;
+        }
+    }
+
+    VEXED_TARGET_AVX2 static void extrudeSegmentsAVX2(const Vector2 *segments, size_t count, float halfThickness, const Color &color, Vertex *quads) {
+        const __m256 half = _mm256_set1_ps(halfThickness);
+        const __m256 zero = _mm256_setzero_ps();
+        const float *source = &segments[0].x;
+        size_t i = 0;
+
+        for(; i + 8 <= count; i += 8) {
+            // Two segments per register, the transpose works within each 128 bit lane so the low lanes end up holding
+            // segments 0, 2, 4, 6 and the high lanes segments 1, 3, 5, 7, which is undone before storing
+            const __m256 r0 = _mm256_loadu_ps(source + (i+0) * 4);
+            const __m256 r1 = _mm256_loadu_ps(source + (i+2) * 4);
+            const __m256 r2 = _mm256_loadu_ps(source + (i+4) * 4);
+            const __m256 r3 = _mm256_loadu_ps(source + (i+6) * 4);
+            const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+            const __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+            const __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+            const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+            const __m256 x1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 y1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+            const __m256 x2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 y2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+
+            const __m256 dx = _mm256_sub_ps(x2, x1);
+            const __m256 dy = _mm256_sub_ps(y2, y1);
+            const __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+            const __m256 scale = _mm256_and_ps(_mm256_cmp_ps(length, zero, _CMP_GT_OQ), _mm256_div_ps(half, length));
+            const __m256 px = _mm256_mul_ps(_mm256_sub_ps(zero, dy), scale);
+            const __m256 py = _mm256_mul_ps(dx, scale);
+
+            const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+            alignas(32) float columns[6][8];
+            _mm256_store_ps(columns[0], _mm256_permutevar8x32_ps(x1, order));
+            _mm256_store_ps(columns[1], _mm256_permutevar8x32_ps(y1, order));
+            _mm256_store_ps(columns[2], _mm256_permutevar8x32_ps(x2, order));
+            _mm256_store_ps(columns[3], _mm256_permutevar8x32_ps(y2, order));
+            _mm256_store_ps(columns[4], _mm256_permutevar8x32_ps(px, order));
+            _mm256_store_ps(columns[5], _mm256_permutevar8x32_ps(py, order));
+
+            for(size_t j = 0; j < 8; j++)
+                writeSegmentQuad(&quads[(i+j)*4], columns[0][j], columns[1][j], columns[2][j], columns[3][j], columns[4][j], columns[5][j], color);
+        }
+
+        extrudeSegmentsSSE2(segments + (i * 2), count - i, halfThickness, color, quads + (i * 4));
+    }
+
+    // Color fill and rectangle expansion are bound by stores, so wider registers do not help there
+    static const SimdKernels avx2Kernels = {
+        fillColorSSE2,
+        rotateVerticesAVX2,
+        extrudeSegmentsAVX2,
+        expandRectanglesSSE2
+    };
+#endif
+
+#if defined(VEXED_SIMD_NEON)
+    static void fillColorNEON(Vertex *vertices, size_t numVertices, const Color &color) {
+        const float32x4_t c = vld1q_f32(&color.r);
+        for(size_t i = 0; i < numVertices; i++)
+            vst1q_f32(&vertices[i].color.r, c);
+    }
+
+    static void rotateVerticesNEON(Vertex *vertices, size_t numVertices, float c, float s) {
+        float32x4_t sum = vdupq_n_f32(0.0f);
+        for(size_t i = 0; i < numVertices; i++)
+            sum = vaddq_f32(sum, vld1q_f32(&vertices[i].position.x));
+
+        float offsetX, offsetY;
+        computeRotationOffset(vgetq_lane_f32(sum, 0) / numVertices, vgetq_lane_f32(sum, 1) / numVertices, c, s, offsetX, offsetY);
+
+        const float cosineValues[4] = { c, c, 1.0f, 1.0f };
+        const float sineValues[4] = { s, -s, 0.0f, 0.0f };
+        const float offsetValues[4] = { offsetX, offsetY, 0.0f, 0.0f };
+        const float32x4_t cosines = vld1q_f32(cosineValues);
+        const float32x4_t sines = vld1q_f32(sineValues);
+        const float32x4_t offset = vld1q_f32(offsetValues);
+
+        for(size_t i = 0; i < numVertices; i++) {
+            const float32x4_t v = vld1q_f32(&vertices[i].position.x);
+            const float32x4_t swapped = vrev64q_f32(v);
+            const float32x4_t r = vaddq_f32(vsubq_f32(vmulq_f32(v, cosines), vmulq_f32(swapped, sines)), offset);
+            vst1q_f32(&vertices[i].position.x, r);
+        }
+    }
+
+    static void extrudeSegmentsNEON(const Vector2 *segments, size_t count, float halfThickness, const Color &color, Vertex *quads) {
+        const float32x4_t half = vdupq_n_f32(halfThickness);
+        const float32x4_t zero = vdupq_n_f32(0.0f);
+        const float *source = &segments[0].x;
+        size_t i = 0;
+
+        for(; i + 4 <= count; i += 4) {
+            // Deinterleaves four segments into columns of x1, y1, x2 and y2
+            const float32x4x4_t s = vld4q_f32(source + (i * 4));
+            const float32x4_t dx = vsubq_f32(s.val[2], s.val[0]);
+            const float32x4_t dy = vsubq_f32(s.val[3], s.val[1]);
+            const float32x4_t length = vsqrtq_f32(vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy)));
+            const uint32x4_t nonZero = vcgtq_f32(length, zero);
+            const float32x4_t scale = vreinterpretq_f32_u32(vandq_u32(nonZero, vreinterpretq_u32_f32(vdivq_f32(half, length))));
+            const float32x4_t px = vmulq_f32(vsubq_f32(zero, dy), scale);
+            const float32x4_t py = vmulq_f32(dx, scale);
+
+            float columns[6][4];
+            vst1q_f32(columns[0], s.val[0]);
+            vst1q_f32(columns[1], s.val[1]);
+            vst1q_f32(columns[2], s.val[2]);
+            vst1q_f32(columns[3], s.val[3]);
+            vst1q_f32(columns[4], px);
+            vst1q_f32(columns[5], py);
+
+            for(size_t j = 0; j < 4; j++)
+                writeSegmentQuad(&quads[(i+j)*4], columns[0][j], columns[1][j], columns[2][j], columns[3][j], columns[4][j], columns[5][j], color);
+        }
+
+        extrudeSegmentsScalar(segments + (i * 2), count - i, halfThickness, color, quads + (i * 4));
+    }
+
+    static const SimdKernels neonKernels = {
+        fillColorNEON,
+        rotateVerticesNEON,
+        extrudeSegmentsNEON,
+        expandRectanglesScalar
+    };
+#endif
+
+    static SimdLevel detectLevel() {
+#if defined(VEXED_SIMD_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        if(info[0] >= 7) {
+            __cpuid(info, 1);
+            const bool osxsave = (info[2] & (1 << 27)) != 0;
+            const bool avx = (info[2] & (1 << 28)) != 0;
+            // The OS also has to save the upper halves of the registers
+            if(osxsave && avx && (_xgetbv(0) & 6) == 6) {
+                __cpuidex(info, 7, 0);
+                if(info[1] & (1 << 5))
+                    return SimdLevel_AVX2;
+            }
+        }
+        return SimdLevel_SSE2;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") ? SimdLevel_AVX2 : SimdLevel_SSE2;
+#endif
+#elif defined(VEXED_SIMD_NEON)
+        return SimdLevel_NEON;
+#else
+        return SimdLevel_Scalar;
+#endif
+    }
+
+    static const SimdKernels *getKernelsForLevel(SimdLevel level) {
+        switch(level) {
+#if defined(VEXED_SIMD_X86)
+            case SimdLevel_SSE2:
+                return &sse2Kernels;
+            case SimdLevel_AVX2:
+                return &avx2Kernels;
+#endif
+#if defined(VEXED_SIMD_NEON)
+            case SimdLevel_NEON:
+                return &neonKernels;
+#endif
+            default:
+                return &scalarKernels;
+        }
+    }
+
+    static std::atomic<const SimdKernels*> activeKernels(nullptr);
+    static std::atomic<SimdLevel> activeLevel(SimdLevel_Scalar);
+
+    static const SimdKernels &getKernels() {
+        const SimdKernels *kernels = activeKernels.load(std::memory_order_acquire);
+
+        if(kernels == nullptr) {
+            // Command buffers may get here from several threads at once, they all pick the same kernels
+            const SimdLevel level = Simd::getSupportedLevel();
+            kernels = getKernelsForLevel(level);
+            activeLevel.store(level, std::memory_order_relaxed);
+            activeKernels.store(kernels, std::memory_order_release);
+        }
+
+        return *kernels;
+    }
+
+    SimdLevel Simd::getLevel() {
+        getKernels();
+        return activeLevel.load(std::memory_order_relaxed);
+    }
+
+    SimdLevel Simd::getSupportedLevel() {
+        static const SimdLevel supportedLevel = detectLevel();
+        return supportedLevel;
+    }
+
+    bool Simd::setLevel(SimdLevel level) {
+        const SimdLevel supportedLevel = getSupportedLevel();
+
+        // NEON and the x86 levels exclude each other, AVX2 implies SSE2
+        bool supported = level == SimdLevel_Scalar || level == supportedLevel;
+        if(level == SimdLevel_SSE2 && supportedLevel == SimdLevel_AVX2)
+            supported = true;
+
+        if(!supported)
+            return false;
+
+        activeLevel.store(level, std::memory_order_relaxed);
+        activeKernels.store(getKernelsForLevel(level), std::memory_order_release);
+        return true;
+    }
+
+    const char *Simd::getLevelName(SimdLevel level) {
+        switch(level) {
+            case SimdLevel_SSE2:
+                return "SSE2";
+            case SimdLevel_AVX2:
+                return "AVX2";
+            case SimdLevel_NEON:
+                return "NEON";
+            default:
+                return "Scalar";
+        }
+    }
+
+    void Simd::fillColor(Vertex *vertices, size_t numVertices, const Color &color) {
+        getKernels().fillColor(vertices, numVertices, color);
+    }
+
+    void Simd::rotateVertices(Vertex *vertices, size_t numVertices, float angleDegrees) {
+        if(numVertices == 0)
+            return;
+
+        // Primitives are usually rotated by the same angle many times in a row
+        thread_local float lastAngle = 0.0f;
+        thread_local float cosAngle = 1.0f;
+        thread_local float sinAngle = 0.0f;
+
+        if(angleDegrees != lastAngle) {
+            const float radians = angleDegrees * (M_PI / 180.0f);
+            cosAngle = std::cos(radians);
+            sinAngle = std::sin(radians);
+            lastAngle = angleDegrees;
+        }
+
+        getKernels().rotateVertices(vertices, numVertices, cosAngle, sinAngle);
+    }
+
+    void Simd::extrudeSegments(const Vector2 *segments, size_t count, float thickness, const Color &color, Vertex *quads) {
+        getKernels().extrudeSegments(segments, count, thickness * 0.5f, color, quads);
+    }
+
+    void Simd::expandRectangles(const Rectangle *rectangles, size_t count, const Color &color, Vertex *quads) {
+        getKernels().expandRectangles(rectangles, count, color, quads);
+    }
+}
\ No newline at end of file
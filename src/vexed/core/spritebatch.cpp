@@ -0,0 +1,207 @@
+#include "spritebatch.h"
+#include "atlas.h"
+#include <cmath>
+#include <cfloat>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+
+namespace vexed {
+    SpriteBatch::SpriteBatch() {
+        sortMode = SpriteSortMode_Deferred;
+        numBatches = 0;
+        active = false;
+    }
+
+    void SpriteBatch::begin(SpriteSortMode sortMode, const Rectangle &clippingRect) {
+        if(active) {
+            std::cerr << "SpriteBatch::begin called twice without end" << std::endl;
+            return;
+        }
+
+        this->sortMode = sortMode;
+        this->clippingRect = clippingRect;
+        active = true;
+
+        textureIds.clear();
+        depths.clear();
+        positions.clear();
+        sizes.clear();
+        uv0s.clear();
+        uv1s.clear();
+        colors.clear();
+        rotations.clear();
+    }
+
+    static uint8_t floatToUnorm8(float value) {
+        if(value <= 0.0f)
+            return 0;
+        if(value >= 1.0f)
+            return 255;
+        return static_cast<uint8_t>(value * 255.0f + 0.5f);
+    }
+
+    void SpriteBatch::draw(uint32_t textureId, const Vector2 &position, const Vector2 &size, const Rectangle &source, float rotationDegrees, const Color &tint, float depth) {
+        if(!active) {
+            std::cerr << "SpriteBatch::draw called outside of begin and end" << std::endl;
+            return;
+        }
+
+        const uint8_t color[4] = { floatToUnorm8(tint.r), floatToUnorm8(tint.g), floatToUnorm8(tint.b), floatToUnorm8(tint.a) };
+        uint32_t packedColor;
+        memcpy(&packedColor, color, sizeof(packedColor));
+
+        textureIds.push_back(textureId);
+        depths.push_back(depth);
+        positions.push_back(position);
+        sizes.push_back(size);
+        uv0s.push_back(Vector2(source.x, source.y));
+        uv1s.push_back(Vector2(source.x + source.width, source.y + source.height));
+        colors.push_back(packedColor);
+        rotations.push_back(rotationDegrees * (M_PI / 180.0f));
+    }
+
+    void SpriteBatch::draw(const Atlas *atlas, uint32_t regionHandle, const Vector2 &position, const Vector2 &size, float rotationDegrees, const Color &tint, float depth) {
+        AtlasRegion region;
+
+        if(atlas == nullptr || !atlas->getRegion(regionHandle, region))
+            return;
+
+        const Rectangle source(region.uv0.x, region.uv0.y, region.uv1.x - region.uv0.x, region.uv1.y - region.uv0.y);
+        draw(region.textureId, position, size, source, rotationDegrees, tint, depth);
+    }
+
+    // Maps a float to an unsigned integer with the same ordering
+    static uint32_t getSortableDepth(float depth) {
+        uint32_t bits;
+        memcpy(&bits, &depth, sizeof(bits));
+        return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+    }
+
+    // Keys hold the sprite index in their lower half, so sorting by the upper half with a stable radix sort keeps
+    // the submission order of sprites with equal keys
+    void SpriteBatch::sort() {
+        const size_t count = textureIds.size();
+
+        keys.resize(count);
+
+        for(size_t i = 0; i < count; i++) {
+            uint32_t key = 0;
+
+            switch(sortMode) {
+                case SpriteSortMode_Texture:
+                    key = textureIds[i];
+                    break;
+                case SpriteSortMode_BackToFront:
+                    key = ~getSortableDepth(depths[i]);
+                    break;
+                case SpriteSortMode_FrontToBack:
+                    key = getSortableDepth(depths[i]);
+                    break;
+                default:
+                    break;
+            }
+
+            keys[i] = (static_cast<uint64_t>(key) << 32) | i;
+        }
+
+        if(sortMode == SpriteSortMode_Deferred)
+            return;
+
+        scratch.resize(count);
+
+        for(size_t pass = 0; pass < 4; pass++) {
+            const size_t shift = 32 + (pass * 8);
+            size_t offsets[256] = { 0 };
+
+            for(size_t i = 0; i < count; i++)
+                offsets[(keys[i] >> shift) & 0xFF]++;
+
+            // All keys share this byte, the pass would not change the order
+            if(offsets[(keys[0] >> shift) & 0xFF] == count)
+                continue;
+
+            size_t sum = 0;
+            for(size_t b = 0; b < 256; b++) {
+                const size_t n = offsets[b];
+                offsets[b] = sum;
+                sum += n;
+            }
+
+            for(size_t i = 0; i < count; i++)
+                scratch[offsets[(keys[i] >> shift) & 0xFF]++] = keys[i];
+
+            keys.swap(scratch);
+        }
+    }
+
+    static Rectangle getSpriteBounds(const Vector2 &position, const Vector2 &size, float rotation) {
+        if(rotation == 0.0f)
+            return Rectangle(position.x, position.y, size.x, size.y);
+
+        // Any rotation stays within the circle around the center that passes through the corners
+        const float radius = 0.5f * std::sqrt(size.x * size.x + size.y * size.y);
+        const Vector2 center(position.x + size.x * 0.5f, position.y + size.y * 0.5f);
+        return Rectangle(center.x - radius, center.y - radius, radius * 2.0f, radius * 2.0f);
+    }
+
+    void SpriteBatch::end(Graphics *graphics) {
+        if(!active) {
+            std::cerr << "SpriteBatch::end called without begin" << std::endl;
+            return;
+        }
+
+        active = false;
+        numBatches = 0;
+
+        const size_t count = textureIds.size();
+
+        if(graphics == nullptr || count == 0)
+            return;
+
+        sort();
+
+        size_t runStart = 0;
+
+        while(runStart < count) {
+            const uint32_t textureId = textureIds[static_cast<uint32_t>(keys[runStart])];
+            size_t runEnd = runStart + 1;
+
+            while(runEnd < count && textureIds[static_cast<uint32_t>(keys[runEnd])] == textureId)
+                runEnd++;
+
+            float minX = FLT_MAX;
+            float minY = FLT_MAX;
+            float maxX = -FLT_MAX;
+            float maxY = -FLT_MAX;
+
+            for(size_t i = runStart; i < runEnd; i++) {
+                const size_t index = static_cast<uint32_t>(keys[i]);
+                const Rectangle bounds = getSpriteBounds(positions[index], sizes[index], rotations[index]);
+                minX = std::min(minX, bounds.x);
+                minY = std::min(minY, bounds.y);
+                maxX = std::max(maxX, bounds.x + bounds.width);
+                maxY = std::max(maxY, bounds.y + bounds.height);
+            }
+
+            const Rectangle runBounds(minX, minY, maxX - minX, maxY - minY);
+            InstanceData *instances = graphics->addInstances(runEnd - runStart, textureId, runBounds, clippingRect);
+
+            for(size_t i = runStart; i < runEnd; i++) {
+                const size_t index = static_cast<uint32_t>(keys[i]);
+                InstanceData &instance = instances[i - runStart];
+                instance.position = positions[index];
+                instance.size = sizes[index];
+                instance.uv0 = uv0s[index];
+                instance.uv1 = uv1s[index];
+                memcpy(instance.color, &colors[index], sizeof(instance.color));
+                instance.rotation = rotations[index];
+                instance.kind = InstanceKind_Rectangle;
+                instance.shape = Vector2(0, 0);
+            }
+
+            numBatches++;
+            runStart = runEnd;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include "statecache.h"
+#include "../../glad/glad.h"
+
+namespace vexed {
+    StateCache::StateCache() {
+        resetCounters();
+        invalidate();
+    }
+
+    void StateCache::invalidate() {
+        blend = UNKNOWN;
+        blendSourceFactor = UNKNOWN;
+        blendDestinationFactor = UNKNOWN;
+        blendSourceAlphaFactor = UNKNOWN;
+        blendDestinationAlphaFactor = UNKNOWN;
+        blendEquation = UNKNOWN;
+        depthTest = UNKNOWN;
+        depthFunc = UNKNOWN;
+        scissorTest = UNKNOWN;
+        for(size_t i = 0; i < 4; i++)
+            scissor[i] = UNKNOWN;
+        program = UNKNOWN;
+        activeTexture = UNKNOWN;
+        texture = UNKNOWN;
+        vertexArray = UNKNOWN;
+        for(size_t i = 0; i < BufferTarget_COUNT; i++)
+            buffers[i] = UNKNOWN;
+    }
+
+    // Textures get bound while they are being loaded, without going through the cache
+    void StateCache::invalidateTexture() {
+        texture = UNKNOWN;
+    }
+
+    void StateCache::setBlend(bool enabled) {
+        if(update(blend, enabled ? 1 : 0)) {
+            if(enabled)
+                glEnable(GL_BLEND);
+            else
+                glDisable(GL_BLEND);
+        }
+    }
+
+    void StateCache::setBlendFunc(int32_t sourceFactor, int32_t destinationFactor) {
+        setBlendFuncSeparate(sourceFactor, destinationFactor, sourceFactor, destinationFactor);
+    }
+
+    void StateCache::setBlendFuncSeparate(int32_t sourceFactor, int32_t destinationFactor, int32_t sourceAlphaFactor, int32_t destinationAlphaFactor) {
+        // All factors are set by the same call, so they count as one change
+        if(blendSourceFactor == sourceFactor && blendDestinationFactor == destinationFactor &&
+           blendSourceAlphaFactor == sourceAlphaFactor && blendDestinationAlphaFactor == destinationAlphaFactor) {
+            numSkipped++;
+            return;
+        }
+        blendSourceFactor = sourceFactor;
+        blendDestinationFactor = destinationFactor;
+        blendSourceAlphaFactor = sourceAlphaFactor;
+        blendDestinationAlphaFactor = destinationAlphaFactor;
+        numIssued++;
+        glBlendFuncSeparate(sourceFactor, destinationFactor, sourceAlphaFactor, destinationAlphaFactor);
+    }
+
+    void StateCache::setBlendEquation(int32_t equation) {
+        if(update(blendEquation, equation))
+            glBlendEquation(equation);
+    }
+
+    void StateCache::setDepthTest(bool enabled) {
+        if(update(depthTest, enabled ? 1 : 0)) {
+            if(enabled)
+                glEnable(GL_DEPTH_TEST);
+            else
+                glDisable(GL_DEPTH_TEST);
+        }
+    }
+
+    void StateCache::setDepthFunc(int32_t func) {
+        if(update(depthFunc, func))
+            glDepthFunc(func);
+    }
+
+    void StateCache::setScissorTest(bool enabled) {
+        if(update(scissorTest, enabled ? 1 : 0)) {
+            numScissorChanges++;
+            if(enabled)
+                glEnable(GL_SCISSOR_TEST);
+            else
+                glDisable(GL_SCISSOR_TEST);
+        }
+    }
+
+    void StateCache::setScissor(int32_t x, int32_t y, int32_t width, int32_t height) {
+        if(scissor[0] == x && scissor[1] == y && scissor[2] == width && scissor[3] == height) {
+            numSkipped++;
+            return;
+        }
+        scissor[0] = x;
+        scissor[1] = y;
+        scissor[2] = width;
+        scissor[3] = height;
+        numIssued++;
+        numScissorChanges++;
+        glScissor(x, y, width, height);
+    }
+
+    void StateCache::useProgram(uint32_t id) {
+        if(update(program, id)) {
+            numProgramChanges++;
+            glUseProgram(id);
+        }
+    }
+
+    void StateCache::setActiveTexture(uint32_t unit) {
+        if(update(activeTexture, unit)) {
+            glActiveTexture(unit);
+            // The texture binding belongs to the unit
+            texture = UNKNOWN;
+        }
+    }
+
+    void StateCache::bindTexture(uint32_t id) {
+        if(update(texture, id)) {
+            numTextureChanges++;
+            glBindTexture(GL_TEXTURE_2D, id);
+        }
+    }
+
+    void StateCache::bindVertexArray(uint32_t id) {
+        if(update(vertexArray, id)) {
+            glBindVertexArray(id);
+            // The element array binding is part of the vertex array state
+            buffers[BufferTarget_ElementArray] = UNKNOWN;
+        }
+    }
+
+    void StateCache::bindBuffer(uint32_t target, uint32_t id) {
+        BufferTarget index = getBufferTarget(target);
+
+        if(index == BufferTarget_COUNT) {
+            numIssued++;
+            glBindBuffer(target, id);
+            return;
+        }
+
+        if(update(buffers[index], id))
+            glBindBuffer(target, id);
+    }
+
+    void StateCache::resetCounters() {
+        numIssued = 0;
+        numSkipped = 0;
+        numProgramChanges = 0;
+        numTextureChanges = 0;
+        numScissorChanges = 0;
+    }
+
+    bool StateCache::update(int64_t &current, int64_t value) {
+        if(current == value) {
+            numSkipped++;
+            return false;
+        }
+        current = value;
+        numIssued++;
+        return true;
+    }
+
+    BufferTarget StateCache::getBufferTarget(uint32_t target) {
+        switch(target) {
+            case GL_ARRAY_BUFFER:
+                return BufferTarget_Array;
+            case GL_ELEMENT_ARRAY_BUFFER:
+                return BufferTarget_ElementArray;
+            case GL_UNIFORM_BUFFER:
+                return BufferTarget_Uniform;
+            default:
+                return BufferTarget_COUNT;
+        }
+    }
+}
\ No newline at end of file
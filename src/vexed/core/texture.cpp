@@ -1,4 +1,5 @@
 #include "texture.h"
+#include "backend.h"
 #include "../../glad/glad.h"
 #include <stdexcept>
 
@@ -8,7 +9,7 @@ namespace vexed {
 
     void Texture::destroy() {
         if(id > 0) {
-            glDeleteTextures(1, &id);
+            Backend::getInstance()->destroyTexture(id);
             id = 0;
         }
     }
@@ -26,46 +27,32 @@ namespace vexed {
 
     bool Texture::loadData(const void *data, const TextureSettings *settings) {
         if (data) {
-            glGenTextures(1, &id);
-            glBindTexture(GL_TEXTURE_2D, id);
+            if(channels < 1 || channels > 4) {
+                std::string error = "Failed to load texture: Unsupported number of channels: " + std::to_string(channels);
+                throw std::runtime_error(error.c_str());
+            }
+
+            TextureDescription description;
+            description.width = width;
+            description.height = height;
+            description.channels = channels;
+            description.format = TextureFormat_RGBA8;
+            description.mipmaps = true;
+            description.data = data;
 
             if(!settings) {
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                description.wrapS = GL_REPEAT;
+                description.wrapT = GL_REPEAT;
+                description.minFilter = GL_LINEAR_MIPMAP_LINEAR;
+                description.magFilter = GL_LINEAR;
             } else {
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, settings->wrapS);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, settings->wrapT);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, settings->minFilter);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, settings->magFilter);
+                description.wrapS = settings->wrapS;
+                description.wrapT = settings->wrapT;
+                description.minFilter = settings->minFilter;
+                description.magFilter = settings->magFilter;
             }
 
-            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-
-            switch(channels) {
-                case 1:
-                    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, data);
-                    break;
-                case 2:
-                    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RG, GL_UNSIGNED_BYTE, data);
-                    break;
-                case 3:
-                    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-                    break;
-                case 4:
-                    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-                    break;
-                default:
-                    glBindTexture(GL_TEXTURE_2D, 0);
-                    glDeleteTextures(1, &id);
-                    std::string error = "Failed to load texture: Unsupported number of channels: " + std::to_string(channels);
-                    throw std::runtime_error(error.c_str());
-                    break;
-            }
-            
-            glGenerateMipmap(GL_TEXTURE_2D);
-            glBindTexture(GL_TEXTURE_2D, 0);
+            id = Backend::getInstance()->createTexture(description);
             return true;
         }
 
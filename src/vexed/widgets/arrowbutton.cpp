@@ -14,6 +14,7 @@ namespace vexed {
 
     void ArrowButton::setDirection(ArrowDirection direction) {
         this->direction = direction;
+        markDirty();
     }
 
     void ArrowButton::onRender() {
@@ -14,6 +14,7 @@ namespace vexed {
 
     void Button::setText(const std::string &text) {
         this->text = text;
+        markDirty();
     }
 
     void Button::onRender() {
@@ -1,5 +1,6 @@
 #include "canvas.h"
 #include <stack>
+#include <cmath>
 
 namespace vexed {
     Canvas::Canvas() : Widget() {
@@ -41,21 +42,108 @@ namespace vexed {
         }
     }
 
+    // Every widget is drawn inside the clip it inherits, widgets that clip their children narrow it down to their own rectangle
+    // The subtree of a layered widget is recorded into its layer when it changed, and otherwise replaced by the cached layer
+    // Layers inside of a layer that is being recorded are drawn as part of it
+    // Overlays are drawn last, so a popup is neither clipped by its parents nor hidden in their cached layer
     void Canvas::render() {
+        auto graphics = Application::getInstance()->getGraphics();
         size_t stackIndex = 0;
+        Widget *layerWidget = nullptr;
+        size_t layerStackIndex = 0; //The subtree of the layer is done once the stack is back at this size
+        Rectangle layerClip;
+        clips[stackIndex] = Rectangle(0, 0, 0, 0);
         stack[stackIndex++] = this;
 
         while (stackIndex > 0) {
             Widget* currentControl = stack[--stackIndex];
+            Rectangle clip = clips[stackIndex];
 
-            currentControl->onRender();
+            if(currentControl->layered && layerWidget == nullptr && !graphics->isRecording()) {
+                if(!needsLayerUpdate(currentControl)) {
+                    addLayer(currentControl, clip);
+                    continue;
+                }
+
+                if(beginLayer(currentControl)) {
+                    layerWidget = currentControl;
+                    layerStackIndex = stackIndex;
+                    layerClip = clip;
+                    // The inherited clip is applied when the layer is drawn, so it may change without redrawing the layer
+                    clip = Rectangle(0, 0, 0, 0);
+                }
+            }
+
+            if(clip.isZero()) {
+                currentControl->onRender();
+            } else {
+                graphics->pushClip(clip);
+                currentControl->onRender();
+                graphics->popClip();
+            }
+
+            Rectangle childClip = clip;
+
+            if(currentControl->clipChildren) {
+                const Rectangle rect = currentControl->getClippingRectangle();
+                childClip = clip.isZero() ? rect : clip.intersect(rect);
+            }
 
             for (auto it = currentControl->children.rbegin(); it != currentControl->children.rend(); ++it) {
                 if (stackIndex < WORKING_STATIC_SIZE) {
+                    clips[stackIndex] = childClip;
                     stack[stackIndex++] = it->get();
                 }
             }
+
+            if(layerWidget && stackIndex == layerStackIndex) {
+                graphics->endRenderTarget();
+                layerWidget->layerDirty = false;
+                addLayer(layerWidget, layerClip);
+                layerWidget = nullptr;
+            }
+        }
+
+        // Indexed, since an overlay may open or close others while it is drawn
+        for(size_t i = 0; i < overlayWidgets.size(); i++)
+            overlayWidgets[i]->onRenderOverlay();
+    }
+
+    // The focused widget may change what it draws every frame (dragging a slider, a blinking cursor) without marking itself
+    bool Canvas::needsLayerUpdate(Widget *widget) const {
+        if(widget->layerDirty || !widget->layerTarget.isValid())
+            return true;
+
+        const Vector2 size = widget->getSize();
+
+        if(widget->layerTarget.getWidth() != static_cast<uint32_t>(std::ceil(size.x)) || widget->layerTarget.getHeight() != static_cast<uint32_t>(std::ceil(size.y)))
+            return true;
+
+        for(Widget *focused = focusedWidget; focused != nullptr; focused = focused->parent) {
+            if(focused == widget)
+                return true;
         }
+
+        return false;
+    }
+
+    // A widget without area, or a layer that can not be created, is drawn without a layer
+    bool Canvas::beginLayer(Widget *widget) {
+        auto graphics = Application::getInstance()->getGraphics();
+        const Vector2 size = widget->getSize();
+        const uint32_t width = static_cast<uint32_t>(std::ceil(size.x));
+        const uint32_t height = static_cast<uint32_t>(std::ceil(size.y));
+
+        if(width == 0 || height == 0 || !widget->layerTarget.create(width, height))
+            return false;
+
+        return graphics->beginRenderTarget(&widget->layerTarget, widget->getPosition());
+    }
+
+    void Canvas::addLayer(Widget *widget, const Rectangle &clip) {
+        auto graphics = Application::getInstance()->getGraphics();
+        const RenderTarget &target = widget->layerTarget;
+        graphics->addRenderTarget(&target, widget->getPosition(), Vector2(target.getWidth(), target.getHeight()), 1.0f, clip);
     }
 
     void Canvas::checkEvents(Widget *widget) {
@@ -70,6 +158,10 @@ namespace vexed {
         bool hovered = widget->containsPoint(mousePosition);
         bool hoveredPreviousFrame = widget->state & WidgetState_Hovered;
 
+        // The scroll wheel is read while drawing, so the layer under the cursor has to be drawn again
+        if(hovered && (mouse->getScrollX() != 0.0f || mouse->getScrollY() != 0.0f))
+            widget->markDirty();
+
         if(hovered) {
             if(!hoveredPreviousFrame) {
                 widget->onMouseEnter();
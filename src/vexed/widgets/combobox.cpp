@@ -21,21 +21,25 @@ namespace vexed {
 
     void Combobox::addItem(const std::string &text) {
         items.push_back(text);
+        markDirty();
     }
 
     void Combobox::setItem(const std::string &text, size_t index) {
         if(index < items.size() && items.size() > 0)
             items[index] = text;
+        markDirty();
     }
 
     void Combobox::removeItem(size_t index) {
         if(index < items.size() && items.size() > 0)
             items.erase(items.begin() + index);
+        markDirty();
     }
 
     void Combobox::setSelectedIndex(uint32_t index) {
         if(index < items.size() && items.size() > 0)
             selectedIndex = index;
+        markDirty();
     }
 
     void Combobox::onRender() {
@@ -83,8 +87,18 @@ namespace vexed {
         } else {
             addText(textPosition, font, true, "Select option...", fontSize, Color::white(), clippingRect);
         }
+    }
+
+    // The dropdown is an overlay, a clipping or layered parent would otherwise hide the part outside of it
+    void Combobox::onRenderOverlay() {
+        Vector2 pos = getPosition();
+        Vector2 size = getSize();
+
+        if(items.size() > 0) {
+            // The dropdown has to cover any widget that is rendered after this one
+            int32_t layer = getLayer();
+            setLayer(layer + 1);
 
-        if(showItems && items.size() > 0) {
             Vector2 positionOptions(pos.x, pos.y + size.y);
             //Vector2 sizeOptions(0, 8);
             Vector2 sizeOptions(0, 4);
@@ -111,7 +125,7 @@ namespace vexed {
             //addBorder(positionOptions, sizeOptions, 1, getColor(WidgetColor_ButtonFocused), borderOptions);
 
 
-            clippingRect = Rectangle(positionOptions.x, positionOptions.y, sizeOptions.x, sizeOptions.y);
+            Rectangle clippingRect(positionOptions.x, positionOptions.y, sizeOptions.x, sizeOptions.y);
 
             Mouse *mouse = Application::getInstance()->getMouse();
             float mx = mouse->getX();
@@ -151,6 +165,8 @@ namespace vexed {
             }
 
             addText(Vector2(positionOptions.x + 4, positionOptions.y), font, true, text, fontSize, Color::white(), clippingRect);
+
+            setLayer(layer);
         }
     }
 
@@ -163,6 +179,7 @@ namespace vexed {
                 setState(WidgetState_Focused, true);
                 setFocusedWidget(this);
                 showItems = !showItems;
+                setOverlay(showItems);
             }
         } else {
             if(isFocused()) {
@@ -184,6 +201,7 @@ namespace vexed {
             //     printf("Clicked %zu\n", getId());
         } else {
             showItems = false;
+            setOverlay(false);
         }
     }
 
@@ -46,6 +46,7 @@ namespace vexed {
         this->value = value;
         text = std::to_string(value);
         truncatDecimalPlaces();
+        markDirty();
     }
 
     float InputFloat::getMinValue() const {
@@ -54,6 +55,7 @@ namespace vexed {
 
     void InputFloat::setMinValue(float value) {
         this->valueMin = value;
+        markDirty();
     }
 
     float InputFloat::getMaxValue() const {
@@ -62,6 +64,7 @@ namespace vexed {
 
     void InputFloat::setMaxValue(float value) {
         this->valueMax = value;
+        markDirty();
     }
 
     float InputFloat::getIncrement() const {
@@ -94,6 +97,7 @@ namespace vexed {
         if(decimalPlaces < 1)
             decimalPlaces = 1;
         this->decimalPlaces = decimalPlaces;
+        markDirty();
     }
 
     void InputFloat::onRender() {
@@ -135,14 +139,8 @@ namespace vexed {
 
             Color cursorColor = getColor(WidgetColor_TextboxText);
             
-            if(Application::getInstance()->getTime() >= (lastKeyStroke + blinkInterval)) {
-                float alpha = (cosf(blinkTimer * 5.0f) + 1.0f) * 0.5f;
-                int on = alpha >= 0.5f;
-                addRectangle(cursorPosition, cursorSize, 0, Color(cursorColor.r, cursorColor.g, cursorColor.b, on * 0.9f), clippingRect);
-                blinkTimer += Application::getInstance()->getDeltaTime();
-            } else {
-                addRectangle(cursorPosition, cursorSize, 0, Color(cursorColor.r, cursorColor.g, cursorColor.b, 0.9f), clippingRect);
-            }
+            const float alpha = updateBlink() ? 0.9f : 0.0f;
+            addRectangle(cursorPosition, cursorSize, 0, Color(cursorColor.r, cursorColor.g, cursorColor.b, alpha), clippingRect);
         }
     }
 
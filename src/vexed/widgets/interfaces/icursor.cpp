@@ -1,5 +1,6 @@
 #include "icursor.h"
 #include <string.h>
+#include <cmath>
 
 namespace vexed {
     ICursor::ICursor() {
@@ -18,6 +19,26 @@ namespace vexed {
         blinkTimer = 0;
     }
 
+    // The cursor stays on for the blink interval after a key stroke, then it is shown while the cosine of 5 times the blink
+    // timer is positive. The frame at which that flips is requested, so an application that only draws on demand still blinks
+    bool ICursor::updateBlink() {
+        Application *application = Application::getInstance();
+        const float blinkStart = lastKeyStroke + blinkInterval;
+
+        if(application->getTime() < blinkStart) {
+            application->requestAnimationFrame(blinkStart);
+            return true;
+        }
+
+        blinkTimer += application->getDeltaTime();
+
+        const float phase = blinkTimer * 5.0f;
+        const float nextFlip = (std::floor((phase - M_PI_2) / M_PI) + 1.0f) * M_PI + M_PI_2;
+        application->requestAnimationFrame(application->getTime() + (nextFlip - phase) / 5.0f);
+
+        return std::cos(phase) >= 0.0f;
+    }
+
     size_t ICursor::getCursorIndex() const {
         return cursorIndex;
     }
@@ -14,6 +14,7 @@ namespace vexed {
 
     void Label::setText(const std::string &text) {
         this->text = text;
+        markDirty();
     }
 
     void Label::onRender() {
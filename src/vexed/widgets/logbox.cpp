@@ -12,6 +12,7 @@ namespace vexed {
 
     void Logbox::addMessage(const std::string &message) {
         messages.add(message);
+        markDirty();
 
         // const size_t lineHeight = font->getLineHeight() * (fontSize / font->getPixelSize());
         // if(messages.count() * lineHeight >= getSize().y)
@@ -0,0 +1,131 @@
+#include "plotpyramid.h"
+#include <cfloat>
+
+namespace vexed {
+    PlotPyramid::PlotPyramid() {
+
+    }
+
+    // Running sums are kept in double, a float sum loses the mean of long ranges
+    struct PlotAccumulator {
+        float min;
+        float max;
+        double sum;
+        uint64_t count;
+
+        PlotAccumulator() : min(FLT_MAX), max(-FLT_MAX), sum(0.0), count(0) {}
+
+        void add(float value) {
+            if(value != value)
+                return;
+            if(value < min)
+                min = value;
+            if(value > max)
+                max = value;
+            sum += value;
+            count++;
+        }
+
+        void add(const PlotBucket &bucket) {
+            if(bucket.count == 0)
+                return;
+            if(bucket.min < min)
+                min = bucket.min;
+            if(bucket.max > max)
+                max = bucket.max;
+            sum += static_cast<double>(bucket.mean) * bucket.count;
+            count += bucket.count;
+        }
+
+        PlotBucket getBucket() const {
+            PlotBucket bucket;
+            bucket.min = count > 0 ? min : 0.0f;
+            bucket.max = count > 0 ? max : 0.0f;
+            bucket.mean = count > 0 ? static_cast<float>(sum / count) : 0.0f;
+            bucket.count = static_cast<uint32_t>(count);
+            return bucket;
+        }
+    };
+
+    void PlotPyramid::append(float value) {
+        samples.push_back(value);
+        updateLevels();
+    }
+
+    void PlotPyramid::append(const float *values, size_t count) {
+        if(values == nullptr || count == 0)
+            return;
+
+        samples.insert(samples.end(), values, values + count);
+        updateLevels();
+    }
+
+    void PlotPyramid::clear() {
+        samples.clear();
+        levels.clear();
+    }
+
+    // Builds the buckets that were completed by the new samples, level by level
+    void PlotPyramid::updateLevels() {
+        for(size_t level = 0; ; level++) {
+            const size_t below = level == 0 ? samples.size() : levels[level - 1].size();
+            const size_t complete = below / BRANCHING;
+
+            if(complete == 0)
+                break;
+
+            if(levels.size() <= level)
+                levels.resize(level + 1);
+
+            std::vector<PlotBucket> &buckets = levels[level];
+
+            if(buckets.size() == complete)
+                break;
+
+            for(size_t b = buckets.size(); b < complete; b++) {
+                PlotAccumulator accumulator;
+
+                for(size_t i = b * BRANCHING; i < (b + 1) * BRANCHING; i++) {
+                    if(level == 0)
+                        accumulator.add(samples[i]);
+                    else
+                        accumulator.add(levels[level - 1][i]);
+                }
+
+                buckets.push_back(accumulator.getBucket());
+            }
+        }
+    }
+
+    bool PlotPyramid::query(size_t begin, size_t end, PlotBucket &result) const {
+        if(end > samples.size())
+            end = samples.size();
+
+        PlotAccumulator accumulator;
+        size_t index = begin;
+
+        while(index < end) {
+            // Climb to the widest stored bucket that starts at the index and still ends inside the range
+            size_t level = 0;
+            size_t span = 1;
+
+            while(level < levels.size()) {
+                const size_t next = span * BRANCHING;
+                if(index % next != 0 || index + next > end || index / next >= levels[level].size())
+                    break;
+                span = next;
+                level++;
+            }
+
+            if(level == 0)
+                accumulator.add(samples[index]);
+            else
+                accumulator.add(levels[level - 1][index / span]);
+
+            index += span;
+        }
+
+        result = accumulator.getBucket();
+        return result.count > 0;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,282 @@
+#include "plotwidget.h"
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+
+namespace vexed {
+    PlotWidget::PlotWidget() : Widget() {
+        setPosition(Vector2(0, 0));
+        setSize(Vector2(300, 100));
+        viewStart = 0.0;
+        viewLength = 2.0;
+        valueMin = 0.0f;
+        valueMax = 1.0f;
+        thickness = 1.0f;
+        autoRange = true;
+        fitting = true;
+        following = true;
+    }
+
+    size_t PlotWidget::addSeries(const Color &color) {
+        series.emplace_back();
+        series.back().color = color;
+        markDirty();
+        return series.size() - 1;
+    }
+
+    void PlotWidget::append(size_t series, float value) {
+        if(series < this->series.size())
+            this->series[series].pyramid.append(value);
+        markDirty();
+    }
+
+    void PlotWidget::append(size_t series, const float *values, size_t count) {
+        if(series < this->series.size())
+            this->series[series].pyramid.append(values, count);
+        markDirty();
+    }
+
+    void PlotWidget::clear() {
+        for(auto &plotSeries : series)
+            plotSeries.pyramid.clear();
+        fitView();
+    }
+
+    size_t PlotWidget::getNumberOfSeries() const {
+        return series.size();
+    }
+
+    size_t PlotWidget::getNumberOfSamples() const {
+        size_t count = 0;
+        for(const auto &plotSeries : series)
+            count = std::max(count, plotSeries.pyramid.getCount());
+        return count;
+    }
+
+    void PlotWidget::setView(double start, double length) {
+        viewStart = start;
+        viewLength = length;
+        fitting = false;
+        following = false;
+        updateView();
+        following = viewStart + viewLength >= getNumberOfSamples();
+        markDirty();
+    }
+
+    void PlotWidget::fitView() {
+        fitting = true;
+        following = true;
+        updateView();
+        markDirty();
+    }
+
+    double PlotWidget::getViewStart() const {
+        return viewStart;
+    }
+
+    double PlotWidget::getViewLength() const {
+        return viewLength;
+    }
+
+    void PlotWidget::setValueRange(float min, float max) {
+        valueMin = min;
+        valueMax = max;
+        autoRange = false;
+        markDirty();
+    }
+
+    void PlotWidget::setAutoRange(bool enabled) {
+        autoRange = enabled;
+        markDirty();
+    }
+
+    void PlotWidget::setThickness(float thickness) {
+        this->thickness = thickness;
+        markDirty();
+    }
+
+    // Keeps the view inside the samples, at least two samples wide
+    void PlotWidget::updateView() {
+        const double total = static_cast<double>(getNumberOfSamples());
+
+        if(fitting) {
+            viewStart = 0.0;
+            viewLength = std::max(total, 2.0);
+            return;
+        }
+
+        viewLength = std::max(2.0, std::min(viewLength, std::max(total, 2.0)));
+
+        if(following)
+            viewStart = total - viewLength;
+
+        if(viewStart + viewLength > total)
+            viewStart = total - viewLength;
+        if(viewStart < 0.0)
+            viewStart = 0.0;
+    }
+
+    void PlotWidget::updateValueRange(size_t begin, size_t end) {
+        float min = FLT_MAX;
+        float max = -FLT_MAX;
+        PlotBucket bucket;
+
+        for(const auto &plotSeries : series) {
+            if(plotSeries.pyramid.query(begin, end, bucket)) {
+                min = std::min(min, bucket.min);
+                max = std::max(max, bucket.max);
+            }
+        }
+
+        if(min > max)
+            return;
+
+        const float padding = (max - min) * 0.05f;
+        valueMin = min - padding;
+        valueMax = max + padding;
+    }
+
+    void PlotWidget::onRender() {
+        auto position = getPosition();
+        auto size = getSize();
+
+        if(size.x < 1.0f || size.y < 1.0f)
+            return;
+
+        Mouse *mouse = Application::getInstance()->getMouse();
+        const double total = static_cast<double>(getNumberOfSamples());
+
+        // Zoom around the sample under the cursor
+        if((getState() & WidgetState_Hovered) && mouse->getScrollY() != 0.0f) {
+            const double anchor = viewStart + ((mouse->getX() - position.x) / size.x) * viewLength;
+            const double length = std::max(2.0, std::min(viewLength * std::pow(0.8, mouse->getScrollY()), std::max(total, 2.0)));
+            viewStart = anchor - (anchor - viewStart) * (length / viewLength);
+            viewLength = length;
+            fitting = false;
+            following = false;
+            updateView();
+            following = viewStart + viewLength >= total;
+        }
+
+        if(isFocused() && mouse->getDeltaX() != 0.0f) {
+            viewStart -= (mouse->getDeltaX() / size.x) * viewLength;
+            fitting = false;
+            following = false;
+            updateView();
+            following = viewStart + viewLength >= total;
+        }
+
+        updateView();
+
+        const Rectangle rect = getClippingRectangle();
+
+        addRectangle(position, size, 0, getColor(WidgetColor_PlotBackground));
+
+        if(autoRange) {
+            const size_t begin = static_cast<size_t>(viewStart);
+            const size_t end = static_cast<size_t>(std::ceil(viewStart + viewLength)) + 1;
+            updateValueRange(begin, end);
+        }
+
+        for(const auto &plotSeries : series)
+            renderSeries(plotSeries, rect);
+    }
+
+    void PlotWidget::renderSeries(const PlotSeries &plotSeries, const Rectangle &rect) {
+        const PlotPyramid &pyramid = plotSeries.pyramid;
+        const size_t count = pyramid.getCount();
+
+        if(count == 0)
+            return;
+
+        const float range = valueMax - valueMin;
+        auto getY = [&] (float value) {
+            const float t = range != 0.0f ? (value - valueMin) / range : 0.5f;
+            return rect.y + (1.0f - t) * rect.height;
+        };
+
+        const size_t columns = static_cast<size_t>(rect.width);
+        const double samplesPerColumn = viewLength / columns;
+
+        points.clear();
+
+        // Zoomed in far enough to see single samples, they are drawn as they are
+        if(samplesPerColumn <= 1.0) {
+            const size_t begin = static_cast<size_t>(viewStart);
+            const size_t end = std::min(count, static_cast<size_t>(std::ceil(viewStart + viewLength)) + 1);
+
+            for(size_t i = begin; i < end; i++) {
+                const float x = rect.x + static_cast<float>(((i - viewStart) / viewLength) * rect.width);
+                points.push_back(Vector2(x, getY(pyramid.getSample(i))));
+            }
+
+            addPolyline(points.data(), points.size(), thickness, plotSeries.color, rect);
+            return;
+        }
+
+        bands.clear();
+
+        for(size_t column = 0; column < columns; column++) {
+            const size_t begin = static_cast<size_t>(viewStart + column * samplesPerColumn);
+            const size_t end = std::max(begin + 1, static_cast<size_t>(viewStart + (column + 1) * samplesPerColumn));
+
+            if(begin >= count)
+                break;
+
+            PlotBucket bucket;
+
+            if(!pyramid.query(begin, end, bucket))
+                continue;
+
+            const float top = getY(bucket.max);
+            const float bottom = getY(bucket.min);
+            const float x = rect.x + column;
+            bands.push_back(Rectangle(x, top, 1.0f, std::max(bottom - top, 1.0f)));
+            points.push_back(Vector2(x + 0.5f, getY(bucket.mean)));
+        }
+
+        Color bandColor = plotSeries.color;
+        bandColor.a *= 0.35f;
+
+        addRectangles(bands.data(), bands.size(), bandColor, rect);
+        addPolyline(points.data(), points.size(), thickness, plotSeries.color, rect);
+    }
+
+    void PlotWidget::onButtonDown(ButtonCode buttoncode) {
+        auto state = getState();
+
+        if(state & WidgetState_Hovered) {
+            if(!isAnyFocused()) {
+                setState(WidgetState_Pressed, true);
+                setState(WidgetState_Focused, true);
+                setFocusedWidget(this);
+            }
+        } else {
+            if(isFocused()) {
+                setState(WidgetState_Pressed, false);
+                setState(WidgetState_Focused, false);
+                setFocusedWidget(nullptr);
+            }
+        }
+    }
+
+    void PlotWidget::onButtonUp(ButtonCode buttoncode) {
+        setState(WidgetState_Pressed, false);
+        setState(WidgetState_Focused, false);
+
+        if(isFocused())
+            setFocusedWidget(nullptr);
+    }
+
+    void PlotWidget::onMouseEnter() {
+        if(!isAnyFocused() || isFocused()) {
+            setState(WidgetState_Hovered, true);
+            setState(WidgetState_Normal, false);
+        }
+    }
+
+    void PlotWidget::onMouseLeave() {
+        setState(WidgetState_Hovered, false);
+        setState(WidgetState_Normal, true);
+    }
+}
\ No newline at end of file
@@ -19,6 +19,7 @@ namespace vexed {
         if(value > valueMax)
             value = valueMax;
         this->value = value;
+        markDirty();
     }
 
     float SliderFloat::getMinValue() const {
@@ -27,6 +28,7 @@ namespace vexed {
 
     void SliderFloat::setMinValue(float value) {
         this->valueMin = value;
+        markDirty();
     }
 
     float SliderFloat::getMaxValue() const {
@@ -35,6 +37,7 @@ namespace vexed {
 
     void SliderFloat::setMaxValue(float value) {
         this->valueMax = value;
+        markDirty();
     }
 
     void SliderFloat::onRender() {
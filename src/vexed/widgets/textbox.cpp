@@ -17,6 +17,7 @@ namespace vexed {
 
     void Textbox::setText(const std::string &text) {
         this->text = text;
+        markDirty();
     }
 
     bool Textbox::isMultiLine() const {
@@ -25,6 +26,7 @@ namespace vexed {
 
     void Textbox::setMultiLine(bool multiLine) {
         this->multiLine = multiLine;
+        markDirty();
     }
 
     void Textbox::onRender() {
@@ -59,14 +61,8 @@ namespace vexed {
 
             Color cursorColor = getColor(WidgetColor_TextboxText);
             
-            if(Application::getInstance()->getTime() >= (lastKeyStroke + blinkInterval)) {
-                float alpha = (cosf(blinkTimer * 5.0f) + 1.0f) * 0.5f;
-                int on = alpha >= 0.5f;
-                addRectangle(cursorPosition, cursorSize, 0, Color(cursorColor.r, cursorColor.g, cursorColor.b, on * 0.9f), clippingRect);
-                blinkTimer += Application::getInstance()->getDeltaTime();
-            } else {
-                addRectangle(cursorPosition, cursorSize, 0, Color(cursorColor.r, cursorColor.g, cursorColor.b, 0.9f), clippingRect);
-            }
+            const float alpha = updateBlink() ? 0.9f : 0.0f;
+            addRectangle(cursorPosition, cursorSize, 0, Color(cursorColor.r, cursorColor.g, cursorColor.b, alpha), clippingRect);
         }
     }
 
@@ -1,8 +1,10 @@
 #include "widget.h"
 #include "../vexed.h"
+#include <algorithm>
 
 namespace vexed {
     Widget *Widget::focusedWidget = nullptr;
+    std::vector<Widget*> Widget::overlayWidgets;
 
     static void setColors(Color *colors) {
         colors[WidgetColor_ArrowButtonNormal] = Color(50, 50, 50, 255);
@@ -31,6 +33,8 @@ namespace vexed {
 
         //WidgetColor_LabelNormal
         colors[WidgetColor_LabelNormal] = Color::white();
+
+        colors[WidgetColor_PlotBackground] = Color(30, 30, 30, 255);
         
         colors[WidgetColor_SliderNormal] = Color(50, 50, 50, 255);
         colors[WidgetColor_SliderHovered] = Color(70, 70, 70, 255);
@@ -51,24 +55,64 @@ namespace vexed {
         state = WidgetState_Normal;
         parent = nullptr;
         shaderId = 0;
+        clipChildren = false;
+        layered = false;
+        layerDirty = true;
+        overlay = false;
         setColors(colors);
     }
 
     Widget::~Widget() {
-
+        setOverlay(false);
+        if(layerTarget.isValid())
+            layerTarget.destroy();
     }
 
+    // The content of a layer is relative to its widget, so moving a layered widget keeps its own layer
     void Widget::setPosition(const Vector2 &position) {
         transform.setPosition(position);
+        if(parent)
+            parent->markDirty();
     }
 
     void Widget::setSize(const Vector2 &size) {
         transform.setScale(size);
+        markDirty();
     }
 
     void Widget::setColor(WidgetColor colorIdx, const Color &color) {
-        if(colorIdx < WidgetColor_COUNT)
+        if(colorIdx < WidgetColor_COUNT) {
             colors[colorIdx] = color;
+            markDirty();
+        }
+    }
+
+    void Widget::setClipChildren(bool enabled) {
+        clipChildren = enabled;
+        markDirty();
+    }
+
+    // Static panels only cost a single textured quad while nothing inside of them changes
+    // Interaction keeps the layer redrawn every frame while the focused widget is part of it
+    void Widget::setLayered(bool enabled) {
+        if(layered == enabled)
+            return;
+
+        layered = enabled;
+        layerDirty = true;
+
+        if(!enabled)
+            layerTarget.destroy();
+
+        if(parent)
+            parent->markDirty();
+    }
+
+    void Widget::markDirty() {
+        for(Widget *widget = this; widget != nullptr; widget = widget->parent) {
+            if(widget->layered)
+                widget->layerDirty = true;
+        }
     }
 
     Rectangle Widget::getClippingRectangle() const {
@@ -88,6 +132,7 @@ namespace vexed {
 
     void Widget::setShader(uint32_t shaderId) {
         this->shaderId = shaderId;
+        markDirty();
     }
 
     void Widget::remove(const Widget *widget) {
@@ -104,14 +149,20 @@ namespace vexed {
 
         if(found) {
             children.erase(children.begin() + index);
+            markDirty();
         }
     }
 
     void Widget::setState(WidgetState s, bool enabled) {
+        const WidgetState previous = state;
+
         if(enabled)
             this->state |= s;
         else 
             this->state &= ~s;
+
+        if(state != previous)
+            markDirty();
     }
 
     bool Widget::isAnyFocused() const {
@@ -132,6 +183,19 @@ namespace vexed {
         focusedWidget = widget;
     }
 
+    // Overlays are drawn in the order they were opened
+    void Widget::setOverlay(bool enabled) {
+        if(overlay == enabled)
+            return;
+
+        overlay = enabled;
+
+        if(enabled)
+            overlayWidgets.push_back(this);
+        else
+            overlayWidgets.erase(std::find(overlayWidgets.begin(), overlayWidgets.end(), this));
+    }
+
     void Widget::addRectangle(const Vector2 &position, const Vector2 &size, float rotationDegrees, const Color &color, const Rectangle &clippingRect, uint32_t shaderId) {
         auto graphics = Application::getInstance()->getGraphics();
         graphics->addRectangle(position, size, rotationDegrees, color, clippingRect, shaderId, this);
@@ -152,7 +216,25 @@ namespace vexed {
         graphics->addLines(segments, count, thickness, color, clippingRect, shaderId, this);
     }
 
+    void Widget::addPolyline(const Vector2 *points, size_t count, float thickness, const Color &color, const Rectangle &clippingRect) {
+        auto graphics = Application::getInstance()->getGraphics();
+        graphics->addPolyline(points, count, thickness, LineJoin_Miter, LineCap_Butt, color, clippingRect, shaderId, this);
+    }
+
+    void Widget::addRectangles(const Rectangle *rectangles, size_t count, const Color &color, const Rectangle &clippingRect) {
+        auto graphics = Application::getInstance()->getGraphics();
+        graphics->addRectangles(rectangles, count, color, clippingRect, shaderId, this);
+    }
+
     void Widget::addBorder(const Vector2 &position, const Vector2 &size, float thickness, const Color &color, BorderOptions borderOptions, const Rectangle &clippingRect) {
+        // A full border is a single SDF quad, it covers the same area as the lines which are centered on the edges
+        if(borderOptions == BorderOptions_All && shaderId == 0) {
+            auto graphics = Application::getInstance()->getGraphics();
+            const float halfThickness = thickness * 0.5f;
+            graphics->addBorder(Vector2(position.x - halfThickness, position.y - halfThickness), Vector2(size.x + thickness, size.y + thickness), thickness, 0.0f, color, clippingRect, this);
+            return;
+        }
+
         Rectangle outerRect(position.x, position.y, size.x, size.y);
         float innerOffset = 0.0f;
 
@@ -187,6 +269,16 @@ namespace vexed {
         addLines(lines, lineCount / 2, thickness, color, clippingRect);
     }
 
+    int32_t Widget::getLayer() const {
+        auto graphics = Application::getInstance()->getGraphics();
+        return graphics->getLayer();
+    }
+
+    void Widget::setLayer(int32_t layer) {
+        auto graphics = Application::getInstance()->getGraphics();
+        graphics->setLayer(layer);
+    }
+
     bool Widget::containsPoint(const Vector2 &point) {
         auto position = getPosition();
         auto size = getSize();